@@ -7,13 +7,18 @@ CONFIG += ordered
 SUBDIRS = VBE \
           VBE-Scenegraph \
           VBE-Profiler \
-          game
+          core \
+          game \
+          bench \
+          tests
 
 
 # Use .depends to specify that a project depends on another.
 VBE-Scenegraph.depends = VBE
 VBE-Profiler.depends = VBE-Scenegraph VBE
-game.depends = VBE VBE-Scenegraph VBE-Profiler
+game.depends = VBE VBE-Scenegraph VBE-Profiler core
+bench.depends = core
+tests.depends = core
 
 OTHER_FILES += \
         common.pri
@@ -0,0 +1,137 @@
+#include "Benchmark.hpp"
+#include <core/AlignedAllocator.hpp>
+#include <atomic>
+#include <cstdio>
+#include <new>
+
+// Heap allocations made with new go through these, so benchmarks can report
+// how many allocations each run makes
+static std::atomic<std::uint64_t> allocationCount(0);
+
+void* operator new(std::size_t size) {
+    ++allocationCount;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if(p == nullptr) std::abort();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Cones, bit sets and the other per-cell arrays come from AlignedAllocator
+// instead, which has to be told to count its blocks too
+static void countAlignedAllocation() {
+    ++allocationCount;
+}
+
+static struct AlignedAllocationCounter {
+    AlignedAllocationCounter() { getAlignedAllocationHook() = countAlignedAllocation; }
+} alignedAllocationCounter;
+
+struct Entry {
+    std::string name;
+    Benchmark::Function function;
+};
+
+static std::vector<Entry>& getRegistry() {
+    static std::vector<Entry> registry;
+    return registry;
+}
+
+BenchmarkState::BenchmarkState(std::uint64_t iterations) : iterations(iterations), remaining(iterations) {
+}
+
+bool BenchmarkState::keepRunning() {
+    if(!started) {
+        started = true;
+        startAllocations = Benchmark::getAllocationCount();
+        start = std::chrono::steady_clock::now();
+    }
+    if(remaining > 0) {
+        --remaining;
+        return true;
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    allocations = Benchmark::getAllocationCount() - startAllocations;
+    return false;
+}
+
+void BenchmarkState::setItemsPerIteration(double items, const char* unit) {
+    itemsPerIteration = items;
+    itemUnit = unit;
+}
+
+void Benchmark::add(const std::string& name, Function f) {
+    getRegistry().push_back({name, f});
+}
+
+std::uint64_t Benchmark::getAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+// Grows the iteration count until a run takes at least minSeconds
+static BenchmarkState run(const Benchmark::Function& f, double minSeconds) {
+    std::uint64_t iterations = 1;
+    while(true) {
+        BenchmarkState state(iterations);
+        f(state);
+        if(state.getSeconds() >= minSeconds || iterations >= (std::uint64_t(1) << 40))
+            return state;
+        double scale = state.getSeconds() > 0.0 ? minSeconds/state.getSeconds()*1.4 : 10.0;
+        iterations = std::uint64_t(double(iterations)*glm::clamp(scale, 2.0, 100.0));
+    }
+}
+
+int Benchmark::runAll(const std::string& filter, double minSeconds, bool csv) {
+    std::vector<std::string> allocating;
+    if(csv) std::printf("name,iterations,ns_per_iteration,items_per_second,item_unit,allocations_per_iteration\n");
+    else std::printf("%-56s %12s %14s %18s %12s\n", "Benchmark", "Iterations", "Time/iter", "Rate", "Allocs/iter");
+    for(const Entry& e : getRegistry()) {
+        if(e.name.find(filter) == std::string::npos) continue;
+        BenchmarkState state = run(e.function, minSeconds);
+        double iterations = double(state.getIterations());
+        double ns = state.getSeconds()*1e9/iterations;
+        double rate = state.getItemsPerIteration()*iterations/state.getSeconds();
+        double allocs = double(state.getAllocations())/iterations;
+        if(csv) {
+            std::printf("%s,%llu,%.3f,%.6g,%s,%.3f\n", e.name.c_str(), (unsigned long long) state.getIterations(),
+                        ns, rate, state.getItemUnit(), allocs);
+        }
+        else {
+            char time[32];
+            if(ns < 1e4) std::snprintf(time, sizeof(time), "%.2f ns", ns);
+            else if(ns < 1e7) std::snprintf(time, sizeof(time), "%.2f us", ns/1e3);
+            else std::snprintf(time, sizeof(time), "%.2f ms", ns/1e6);
+            char items[48] = "";
+            if(state.getItemsPerIteration() > 0.0) {
+                const char* prefix = rate >= 1e9 ? "G" : rate >= 1e6 ? "M" : rate >= 1e3 ? "k" : "";
+                double scale = rate >= 1e9 ? 1e9 : rate >= 1e6 ? 1e6 : rate >= 1e3 ? 1e3 : 1.0;
+                std::snprintf(items, sizeof(items), "%.3g%s %s/s", rate/scale, prefix, state.getItemUnit());
+            }
+            std::printf("%-56s %12llu %14s %18s %12.2f\n", e.name.c_str(), (unsigned long long) state.getIterations(),
+                        time, items, allocs);
+        }
+        if(state.getExpectsNoAllocations() && state.getAllocations() > 0) allocating.push_back(e.name);
+        std::fflush(stdout);
+    }
+    for(const std::string& name : allocating)
+        std::fprintf(stderr, "%s allocates in its steady state\n", name.c_str());
+    return int(allocating.size());
+}
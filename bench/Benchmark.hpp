@@ -0,0 +1,77 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <core/CoreCommons.hpp>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <cstdint>
+
+// Tiny benchmark harness in the spirit of Google Benchmark. A benchmark is a
+// function that does its setup and then loops while state.keepRunning(). The
+// harness picks the iteration count so that every benchmark runs for at
+// least the minimum time.
+class BenchmarkState {
+    public:
+        BenchmarkState(std::uint64_t iterations);
+
+        bool keepRunning();
+
+        // Work done by a single iteration, reported as a rate
+        void setItemsPerIteration(double items, const char* unit = "items");
+        // Marks the timed loop as one that shouldn't touch the heap. Runs
+        // that do anyway are reported as failures.
+        void expectNoAllocations() { allocationFree = true; }
+
+        std::uint64_t getIterations() const { return iterations; }
+        double getSeconds() const { return seconds; }
+        std::uint64_t getAllocations() const { return allocations; }
+        double getItemsPerIteration() const { return itemsPerIteration; }
+        const char* getItemUnit() const { return itemUnit; }
+        bool getExpectsNoAllocations() const { return allocationFree; }
+
+    private:
+        std::uint64_t iterations;
+        std::uint64_t remaining;
+        bool started = false;
+        double seconds = 0.0;
+        std::uint64_t allocations = 0;
+        std::uint64_t startAllocations = 0;
+        double itemsPerIteration = 0.0;
+        const char* itemUnit = "items";
+        bool allocationFree = false;
+        std::chrono::steady_clock::time_point start;
+};
+
+class Benchmark {
+    public:
+        typedef std::function<void(BenchmarkState&)> Function;
+
+        struct Registrar {
+            Registrar(const std::string& name, Function f) { add(name, f); }
+        };
+
+        static void add(const std::string& name, Function f);
+        // Runs every benchmark whose name contains filter. Output is a table,
+        // or CSV if csv is set. Returns how many of the benchmarks that expect
+        // no allocations made some.
+        static int runAll(const std::string& filter, double minSeconds, bool csv);
+
+        // Heap allocations made by this process so far
+        static std::uint64_t getAllocationCount();
+};
+
+// Keeps the compiler from optimizing a result away
+template<typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#define BENCHMARK_CONCAT2(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT2(a, b)
+// Registers a benchmark at startup. Variadic so that the function can have
+// commas in it.
+#define BENCHMARK(name, ...) \
+    static Benchmark::Registrar BENCHMARK_CONCAT(benchmarkRegistrar, __LINE__)(name, __VA_ARGS__)
+
+#endif //BENCHMARK_HPP
@@ -0,0 +1,323 @@
+#include "Benchmark.hpp"
+#include "Maps.hpp"
+#include <core/ConeSolver.hpp>
+#include <core/OrthoSolver.hpp>
+#include <core/IntervalSolver.hpp>
+#include <core/BatchSolver.hpp>
+#include <core/ChunkedBlockers.hpp>
+#include <sstream>
+#include <cstdio>
+
+// Full solves over a grid of sizes, maps and origins. Each benchmark solves
+// once during setup, so the numbers are for the steady state where buffers
+// and face cone tables already exist, as when the demo recomputes.
+
+enum ConeMode {
+    PLANAR_2D = 0,
+    PLANAR_3D,
+    VOLUMETRIC
+};
+
+static const char* getModeName(ConeMode mode) {
+    switch(mode) {
+        case PLANAR_2D: return "2D";
+        case PLANAR_3D: return "3D faces";
+        case VOLUMETRIC: return "volumetric";
+    }
+    return "";
+}
+
+template<typename T>
+static void setMode(BasicConeSolver<T>& solver, ConeMode mode) {
+    solver.genMode2D = mode == PLANAR_2D;
+    solver.volumetric = mode == VOLUMETRIC;
+}
+
+static std::string getSizeName(const vec3i& size) {
+    std::ostringstream s;
+    s << size.x << "x" << size.y;
+    if(size.z > 1) s << "x" << size.z;
+    return s.str();
+}
+
+// Rolling solves only keep two shells of cones and hand cells to a sink that
+// counts the visible ones. T is the precision of the solver.
+template<typename T = float>
+static void addConeSolve(ConeMode mode, const vec3i& size, Maps::Kind map, bool corner, bool sparse = false,
+                         bool rolling = false) {
+    std::string name = std::string("ConeSolver/solve/") + getModeName(mode) + "/" + getSizeName(size) + "/" +
+                       Maps::getName(map) + (corner ? "/corner" : "/center") + (sparse ? "/sparse" : "") +
+                       (rolling ? "/rolling" : "") + (sizeof(T) == sizeof(double) ? "/double" : "");
+    Benchmark::add(name, [=](BenchmarkState& state) {
+        vec3i origin = corner ? vec3i(0) : size/2/4*4;
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, map, origin);
+        BasicConeSolver<T> solver;
+        setMode(solver, mode);
+        solver.sparseFrontier = sparse;
+        solver.rollingShells = rolling;
+        std::size_t visible = 0;
+        if(rolling)
+            solver.sink = [&](const vec3i& p, const BasicAngleDef<T>& cone) {
+                (void) p;
+                visible += cone.full || cone.halfAngle != 0.0f;
+            };
+        solver.solve(blockers, origin);
+        while(state.keepRunning())
+            solver.solve(blockers, origin);
+        doNotOptimize(visible);
+        state.setItemsPerIteration(double(size.x)*size.y*size.z, "cells");
+        state.expectNoAllocations();
+    });
+}
+
+// Toggles the same blocker next to the origin on and off, which is what
+// clicking in the demo does
+static void addConeUpdate(ConeMode mode, const vec3i& size, Maps::Kind map) {
+    std::string name = std::string("ConeSolver/updateBlocker/") + getModeName(mode) + "/" + getSizeName(size) + "/" +
+                       Maps::getName(map);
+    Benchmark::add(name, [=](BenchmarkState& state) {
+        vec3i origin = size/2/4*4;
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, map, origin);
+        ConeSolver solver;
+        setMode(solver, mode);
+        solver.solve(blockers, origin);
+        vec3i changed = origin + vec3i(2, 1, 0);
+        // Both states of the cell once, so the queues have grown already
+        for(int i = 0; i < 2; ++i) {
+            blockers.toggle(changed);
+            solver.updateBlocker(blockers, changed);
+        }
+        while(state.keepRunning()) {
+            blockers.toggle(changed);
+            solver.updateBlocker(blockers, changed);
+        }
+        state.setItemsPerIteration(1, "updates");
+        state.expectNoAllocations();
+    });
+}
+
+static void addOrthoSolve(const vec2i& size, Maps::Kind map) {
+    std::string name = std::string("OrthoSolver/solve/") + getSizeName(vec3i(size, 1)) + "/" + Maps::getName(map);
+    Benchmark::add(name, [=](BenchmarkState& state) {
+        BlockerGrid blockers(vec3i(size, 1));
+        Maps::generate(blockers, map, vec3i(0));
+        OrthoSolver solver;
+        vec3f sunDir = glm::normalize(vec3f(-1.0f, 1.4f, 0.0f));
+        solver.solve(blockers, sunDir);
+        while(state.keepRunning())
+            solver.solve(blockers, sunDir);
+        state.setItemsPerIteration(double(size.x)*size.y, "cells");
+        state.expectNoAllocations();
+    });
+}
+
+static void addOrthoUpdate(const vec2i& size, Maps::Kind map) {
+    std::string name = std::string("OrthoSolver/updateBlocker/") + getSizeName(vec3i(size, 1)) + "/" + Maps::getName(map);
+    Benchmark::add(name, [=](BenchmarkState& state) {
+        BlockerGrid blockers(vec3i(size, 1));
+        Maps::generate(blockers, map, vec3i(0));
+        OrthoSolver solver;
+        solver.solve(blockers, glm::normalize(vec3f(-1.0f, 1.4f, 0.0f)));
+        vec2i changed = size/2;
+        for(int i = 0; i < 2; ++i) {
+            blockers.toggle(vec3i(changed, 0));
+            solver.updateBlocker(blockers, changed);
+        }
+        while(state.keepRunning()) {
+            blockers.toggle(vec3i(changed, 0));
+            solver.updateBlocker(blockers, changed);
+        }
+        state.setItemsPerIteration(1, "updates");
+        state.expectNoAllocations();
+    });
+}
+
+// Same cells as the 2D ConeSolver solves, to compare against them. A
+// positive range is compared against addRangeSolve's.
+static void addIntervalSolve(const vec3i& size, Maps::Kind map, bool corner, float range = 0.0f) {
+    std::ostringstream name;
+    name << "IntervalSolver/solve/" << getSizeName(size) << "/" << Maps::getName(map) << (corner ? "/corner" : "/center");
+    if(range > 0.0f) name << "/range" << range;
+    Benchmark::add(name.str(), [=](BenchmarkState& state) {
+        vec3i origin = corner ? vec3i(0) : size/2/4*4;
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, map, origin);
+        IntervalSolver solver;
+        solver.maxRange = range;
+        solver.solve(blockers, origin);
+        while(state.keepRunning())
+            solver.solve(blockers, origin);
+        state.setItemsPerIteration(range > 0.0f ? 3.14159265f*range*range : double(size.x)*size.y, "cells");
+        state.expectNoAllocations();
+    });
+}
+
+// With a cache, the agents stand still and every batch after the first one
+// is served from it
+static void addBatchSolve(const vec3i& size, Maps::Kind map, int origins, bool cached = false) {
+    std::ostringstream name;
+    name << "BatchSolver/solve/" << getSizeName(size) << "/" << Maps::getName(map) << "/" << origins << " origins"
+         << (cached ? "/cached" : "");
+    Benchmark::add(name.str(), [=](BenchmarkState& state) {
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, map, vec3i(0));
+        std::vector<vec3i> points;
+        for(int i = 0; i < origins; ++i) {
+            vec3i p = vec3i((i*37)%size.x, (i*61)%size.y, (i*17)%size.z);
+            blockers.setBlocked(p, false);
+            points.push_back(p);
+        }
+        BatchSolver solver(blockers);
+        solver.volumetric = size.z > 1;
+        VisibilityCache cache(64 << 20);
+        cache.volumetric = solver.volumetric;
+        if(cached) solver.cache = &cache;
+        std::vector<BitSet> results;
+        solver.solve(points, results);
+        while(state.keepRunning())
+            solver.solve(points, results);
+        state.setItemsPerIteration(double(size.x)*size.y*size.z*origins, "cells");
+        state.expectNoAllocations();
+    });
+}
+
+// Opening a saved map, which maps the file instead of reading it, and then
+// touching one cell per page so the cost of faulting it in shows up too.
+// The brick summary is left for the first sparse solve, so nothing is
+// allocated either.
+static void addMapLoad(const vec3i& size, Maps::Kind map) {
+    std::string name = std::string("BlockerGrid/load/") + getSizeName(size) + "/" + Maps::getName(map);
+    Benchmark::add(name, [=](BenchmarkState& state) {
+        std::string path = "/tmp/bench-" + getSizeName(size) + "-" + Maps::getName(map) + ".map";
+        {
+            BlockerGrid blockers(size);
+            Maps::generate(blockers, map, vec3i(0));
+            if(!blockers.save(path)) return;
+        }
+        BlockerGrid blockers(vec3i(1));
+        while(state.keepRunning()) {
+            blockers.load(path);
+            int blocked = 0;
+            for(std::size_t i = 0; i < blockers.getWordCount(); i += 4096/sizeof(std::uint64_t))
+                blocked += blockers.getWords()[i] != 0;
+            doNotOptimize(blocked);
+        }
+        state.setItemsPerIteration(double(size.x)*size.y*size.z, "cells");
+        state.expectNoAllocations();
+        std::remove(path.c_str());
+    });
+}
+
+// Sight-limited queries from the center of a big map: a euclidean range,
+// and optionally a 60 degree view along x. Only the cells in range are
+// counted, so the rate can be compared with the full solves above.
+static void addRangeSolve(ConeMode mode, const vec3i& size, Maps::Kind map, float range, bool view) {
+    std::ostringstream name;
+    name << "ConeSolver/solve/" << getModeName(mode) << "/" << getSizeName(size) << "/" << Maps::getName(map)
+         << "/center/range" << range << (view ? "/view" : "");
+    Benchmark::add(name.str(), [=](BenchmarkState& state) {
+        vec3i origin = size/2/4*4;
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, map, origin);
+        ConeSolver solver;
+        setMode(solver, mode);
+        solver.sparseFrontier = true;
+        solver.maxRange = range;
+        // tan(30 degrees)
+        if(view) solver.viewCone = {{1.0f, 0.0f, 0.0f}, 0.57735027f, false};
+        solver.solve(blockers, origin);
+        while(state.keepRunning())
+            solver.solve(blockers, origin);
+        float area = 3.14159265f*range*range;
+        state.setItemsPerIteration(mode == VOLUMETRIC ? area*range*4.0f/3.0f : area, "cells");
+        state.expectNoAllocations();
+    });
+}
+
+// Rolling solve that streams its blockers in chunks from a grid, so the cost
+// of loading and dropping chunks shows up against the rolling solve above
+static void addChunkedSolve(const vec3i& size, Maps::Kind map, int chunkShift) {
+    std::ostringstream name;
+    name << "ConeSolver/solve/" << getModeName(VOLUMETRIC) << "/" << getSizeName(size) << "/"
+         << Maps::getName(map) << "/center/chunked" << (1 << chunkShift);
+    Benchmark::add(name.str(), [=](BenchmarkState& state) {
+        vec3i origin = size/2/4*4;
+        BlockerGrid source(size);
+        Maps::generate(source, map, origin);
+        GridChunkProvider provider(source);
+        ChunkedBlockers blockers(provider, size, chunkShift);
+        ConeSolver solver;
+        setMode(solver, VOLUMETRIC);
+        solver.rollingShells = true;
+        std::size_t visible = 0;
+        solver.sink = [&](const vec3i& p, const AngleDef& cone) {
+            (void) p;
+            visible += cone.full || cone.halfAngle != 0.0f;
+        };
+        solver.solve(blockers, origin);
+        while(state.keepRunning())
+            solver.solve(blockers, origin);
+        doNotOptimize(visible);
+        state.setItemsPerIteration(double(size.x)*size.y*size.z, "cells");
+        state.expectNoAllocations();
+    });
+}
+
+static bool registerAll() {
+    Maps::Kind maps[4] = {Maps::OPEN, Maps::RANDOM, Maps::CORRIDORS, Maps::CAVES};
+    int planarSizes[3] = {64, 256, 1024};
+    for(int n : planarSizes)
+        for(Maps::Kind map : maps)
+            for(int corner = 0; corner < 2; ++corner) {
+                addConeSolve(PLANAR_2D, vec3i(n, n, 1), map, corner != 0);
+                if(n <= 256) addConeSolve(PLANAR_3D, vec3i(n, n, 1), map, corner != 0);
+            }
+    int volumeSizes[2] = {32, 64};
+    for(int n : volumeSizes)
+        for(Maps::Kind map : maps)
+            for(int corner = 0; corner < 2; ++corner)
+                addConeSolve(VOLUMETRIC, vec3i(n), map, corner != 0);
+    // Sparse frontier against the dense sweeps above
+    for(Maps::Kind map : maps) {
+        addConeSolve(PLANAR_2D, vec3i(256, 256, 1), map, false, true);
+        addConeSolve(VOLUMETRIC, vec3i(64), map, false, true);
+        addConeSolve(VOLUMETRIC, vec3i(64), map, false, false, true);
+        addChunkedSolve(vec3i(64), map, 4);
+    }
+    // Double precision against the same solves in float above
+    for(Maps::Kind map : maps) {
+        addConeSolve<double>(PLANAR_2D, vec3i(256, 256, 1), map, false);
+        addConeSolve<double>(PLANAR_3D, vec3i(256, 256, 1), map, false);
+        addConeSolve<double>(VOLUMETRIC, vec3i(64), map, false);
+    }
+    for(Maps::Kind map : maps) {
+        addRangeSolve(PLANAR_2D, vec3i(1024, 1024, 1), map, 32.0f, false);
+        addRangeSolve(PLANAR_2D, vec3i(1024, 1024, 1), map, 32.0f, true);
+        addRangeSolve(VOLUMETRIC, vec3i(64), map, 16.0f, false);
+        addRangeSolve(VOLUMETRIC, vec3i(64), map, 16.0f, true);
+    }
+    for(Maps::Kind map : maps) {
+        addConeUpdate(PLANAR_2D, vec3i(256, 256, 1), map);
+        addConeUpdate(VOLUMETRIC, vec3i(64), map);
+    }
+    for(int n : planarSizes)
+        for(Maps::Kind map : maps)
+            addOrthoSolve(vec2i(n), map);
+    for(Maps::Kind map : maps)
+        addOrthoUpdate(vec2i(256), map);
+    for(int n : planarSizes)
+        for(Maps::Kind map : maps)
+            for(int corner = 0; corner < 2; ++corner)
+                addIntervalSolve(vec3i(n, n, 1), map, corner != 0);
+    for(Maps::Kind map : maps)
+        addIntervalSolve(vec3i(1024, 1024, 1), map, false, 32.0f);
+    addBatchSolve(vec3i(32), Maps::CAVES, 64);
+    addBatchSolve(vec3i(32), Maps::CAVES, 64, true);
+    addMapLoad(vec3i(256), Maps::CAVES);
+    addMapLoad(vec3i(1024, 1024, 64), Maps::RANDOM);
+    return true;
+}
+
+static bool registered = registerAll();
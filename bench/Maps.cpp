@@ -0,0 +1,84 @@
+#include "Maps.hpp"
+#include <random>
+
+namespace Maps {
+
+const char* getName(Kind kind) {
+    switch(kind) {
+        case OPEN: return "open";
+        case RANDOM: return "random";
+        case CORRIDORS: return "corridors";
+        case CAVES: return "caves";
+    }
+    return "";
+}
+
+// 10% of the cells blocked, uniformly
+static void generateRandom(BlockerGrid& blockers, std::mt19937& random) {
+    vec3i size = blockers.getSize();
+    for(int z = 0; z < size.z; ++z)
+        for(int y = 0; y < size.y; ++y)
+            for(int x = 0; x < size.x; ++x)
+                blockers.setBlocked(vec3i(x, y, z), random()%10 == 0);
+}
+
+// Solid rock with one cell wide corridors along every axis every 4 cells,
+// and an eighth of the corridor cells walled off
+static void generateCorridors(BlockerGrid& blockers, std::mt19937& random) {
+    vec3i size = blockers.getSize();
+    for(int z = 0; z < size.z; ++z)
+        for(int y = 0; y < size.y; ++y)
+            for(int x = 0; x < size.x; ++x) {
+                int aligned = (x%4 == 0) + (y%4 == 0) + (z%4 == 0);
+                // On planar maps z is always 0, so any x or y multiple of 4 is
+                // a corridor
+                bool corridor = aligned >= 2;
+                blockers.setBlocked(vec3i(x, y, z), !corridor || random()%8 == 0);
+            }
+}
+
+// Cellular automaton caves: 45% random fill, then a few smoothing passes
+// where a cell becomes rock if most of its neighbours are
+static void generateCaves(BlockerGrid& blockers, std::mt19937& random) {
+    vec3i size = blockers.getSize();
+    int reach = size.z > 1 ? 1 : 0;
+    int threshold = size.z > 1 ? 14 : 5;
+    std::vector<unsigned char> cells(std::size_t(size.x)*size.y*size.z);
+    for(unsigned char& c : cells) c = random()%100 < 45;
+    auto index = [&](int x, int y, int z) { return x + std::size_t(size.x)*(y + std::size_t(size.y)*z); };
+    for(int pass = 0; pass < 4; ++pass) {
+        std::vector<unsigned char> next(cells.size());
+        for(int z = 0; z < size.z; ++z)
+            for(int y = 0; y < size.y; ++y)
+                for(int x = 0; x < size.x; ++x) {
+                    int rock = 0;
+                    for(int dz = -reach; dz <= reach; ++dz)
+                        for(int dy = -1; dy <= 1; ++dy)
+                            for(int dx = -1; dx <= 1; ++dx) {
+                                vec3i n(x+dx, y+dy, z+dz);
+                                if(!blockers.isInside(n)) ++rock;
+                                else rock += cells[index(n.x, n.y, n.z)];
+                            }
+                    next[index(x, y, z)] = rock >= threshold;
+                }
+        cells.swap(next);
+    }
+    for(int z = 0; z < size.z; ++z)
+        for(int y = 0; y < size.y; ++y)
+            for(int x = 0; x < size.x; ++x)
+                blockers.setBlocked(vec3i(x, y, z), cells[index(x, y, z)] != 0);
+}
+
+void generate(BlockerGrid& blockers, Kind kind, const vec3i& origin) {
+    std::mt19937 random(1234);
+    blockers.clear();
+    switch(kind) {
+        case OPEN: break;
+        case RANDOM: generateRandom(blockers, random); break;
+        case CORRIDORS: generateCorridors(blockers, random); break;
+        case CAVES: generateCaves(blockers, random); break;
+    }
+    blockers.setBlocked(origin, false);
+}
+
+}
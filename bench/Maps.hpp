@@ -0,0 +1,22 @@
+#ifndef MAPS_HPP
+#define MAPS_HPP
+
+#include <core/BlockerGrid.hpp>
+
+// Blocker layouts used by the solver benchmarks. All of them are generated
+// from a fixed seed so every run measures the same map.
+namespace Maps {
+    enum Kind {
+        OPEN = 0,
+        RANDOM,
+        CORRIDORS,
+        CAVES
+    };
+
+    const char* getName(Kind kind);
+    // Fills blockers with a map of the given kind. origin is always left
+    // clear.
+    void generate(BlockerGrid& blockers, Kind kind, const vec3i& origin);
+}
+
+#endif //MAPS_HPP
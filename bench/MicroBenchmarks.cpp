@@ -0,0 +1,257 @@
+#include "Benchmark.hpp"
+#include <core/Cone.hpp>
+#include <core/AngleBatch.hpp>
+#include <core/Square.hpp>
+#include <random>
+
+// Inputs are cycled through so that branch predictors and caches see
+// something closer to a real solve than one value over and over
+#define INPUT_COUNT 4096
+
+// Normalized corners of the faces of a block of cells in front of the origin,
+// which is what face cones are built from
+template<typename T>
+static const std::vector<typename ConePrecision<T>::Vec3>& getFaceCorners();
+
+template<>
+const std::vector<vec3f>& getFaceCorners<float>() {
+    static std::vector<vec3f> corners;
+    if(!corners.empty()) return corners;
+    for(int z = -8; z <= 8; ++z)
+        for(int y = -8; y <= 8; ++y)
+            for(int x = 1; x <= 16 && corners.size() < INPUT_COUNT*4; ++x) {
+                vec3f c = vec3f(x, y, z) + vec3f(0.5f, 0.0f, 0.0f);
+                corners.push_back(glm::normalize(c + vec3f(0.0f, 0.5f, 0.5f)));
+                corners.push_back(glm::normalize(c + vec3f(0.0f,-0.5f, 0.5f)));
+                corners.push_back(glm::normalize(c + vec3f(0.0f, 0.5f,-0.5f)));
+                corners.push_back(glm::normalize(c + vec3f(0.0f,-0.5f,-0.5f)));
+            }
+    return corners;
+}
+
+// The same corners in double, so that both precisions get the same work
+template<>
+const std::vector<vec3d>& getFaceCorners<double>() {
+    static std::vector<vec3d> corners;
+    if(corners.empty())
+        for(const vec3f& c : getFaceCorners<float>())
+            corners.push_back(glm::normalize(vec3d(c)));
+    return corners;
+}
+
+// Random cones, with some full, empty and parallel ones mixed in like in a
+// real solve
+template<typename T>
+static const std::vector<BasicAngleDef<T>>& getCones();
+
+template<>
+const std::vector<AngleDef>& getCones<float>() {
+    static std::vector<AngleDef> cones;
+    if(!cones.empty()) return cones;
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    for(int i = 0; i < INPUT_COUNT*2; ++i) {
+        int kind = random()%16;
+        if(kind == 0) cones.push_back({{0.0f, 0.0f, 0.0f}, 0.0f, true});
+        else if(kind == 1) cones.push_back({{0.0f, 0.0f, 0.0f}, 0.0f, false});
+        else if(kind == 2 && i > 0) cones.push_back(cones[i-1]);
+        else {
+            vec3f dir = glm::normalize(vec3f(u(random), u(random), u(random)));
+            cones.push_back({dir, glm::abs(u(random))*0.5f, false});
+        }
+    }
+    return cones;
+}
+
+template<>
+const std::vector<AngleDefDouble>& getCones<double>() {
+    static std::vector<AngleDefDouble> cones;
+    if(cones.empty())
+        for(const AngleDef& c : getCones<float>())
+            cones.push_back({vec3d(c.dir), double(c.halfAngle), c.full});
+    return cones;
+}
+
+static const std::vector<Square>& getSquares() {
+    static std::vector<Square> squares;
+    if(!squares.empty()) return squares;
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> u(0.0f, 4.0f);
+    for(int i = 0; i < INPUT_COUNT*2; ++i)
+        squares.push_back({{u(random), u(random)}, {u(random)*0.5f, u(random)*0.5f}});
+    return squares;
+}
+
+BENCHMARK("Cone/getCone/2 points", [](BenchmarkState& state) {
+    const std::vector<vec3f>& p = getFaceCorners<float>();
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(getCone(p[i*4], p[i*4+1]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+});
+
+BENCHMARK("Cone/getCone/3 points", [](BenchmarkState& state) {
+    const std::vector<vec3f>& p = getFaceCorners<float>();
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(getCone(p[i*4], p[i*4+1], p[i*4+2]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+});
+
+BENCHMARK("Cone/insideCone", [](BenchmarkState& state) {
+    const std::vector<vec3f>& p = getFaceCorners<float>();
+    std::vector<AngleDef> cones;
+    for(std::size_t i = 0; i < INPUT_COUNT; ++i)
+        cones.push_back(getCone(p[i*4], p[i*4+1]));
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(insideCone(cones[i], p[i*4+2]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+});
+
+template<typename T>
+static void benchMinConeUnroll(BenchmarkState& state) {
+    const std::vector<typename ConePrecision<T>::Vec3>& p = getFaceCorners<T>();
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(minConeUnroll(p[i*4], p[i*4+1], p[i*4+2], p[i*4+3]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+}
+
+BENCHMARK("Cone/minConeUnroll", benchMinConeUnroll<float>);
+BENCHMARK("Cone/minConeUnroll/double", benchMinConeUnroll<double>);
+
+BENCHMARK("Cone/minCone", [](BenchmarkState& state) {
+    const std::vector<vec3f>& p = getFaceCorners<float>();
+    std::vector<std::vector<vec3f>> sets;
+    for(std::size_t i = 0; i < INPUT_COUNT; ++i)
+        sets.push_back(std::vector<vec3f>(p.begin() + i*4, p.begin() + i*4 + 4));
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(minCone(sets[i]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+});
+
+BENCHMARK("Cone/getSmallestConeApprox", [](BenchmarkState& state) {
+    const std::vector<vec3f>& p = getFaceCorners<float>();
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(getSmallestConeApprox(&p[i*4], 4));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+});
+
+template<typename T>
+static void benchUnion(BenchmarkState& state) {
+    const std::vector<BasicAngleDef<T>>& c = getCones<T>();
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(BasicAngleDef<T>::angleUnion(c[i*2], c[i*2+1]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+}
+
+BENCHMARK("AngleDef/angleUnion", benchUnion<float>);
+BENCHMARK("AngleDef/angleUnion/double", benchUnion<double>);
+
+template<typename T>
+static void benchIntersection(BenchmarkState& state) {
+    const std::vector<BasicAngleDef<T>>& c = getCones<T>();
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(BasicAngleDef<T>::angleIntersection(c[i*2], c[i*2+1]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+}
+
+BENCHMARK("AngleDef/angleIntersection", benchIntersection<float>);
+BENCHMARK("AngleDef/angleIntersection/double", benchIntersection<double>);
+
+template<typename T>
+static void benchOverlap(BenchmarkState& state) {
+    const std::vector<BasicAngleDef<T>>& c = getCones<T>();
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(BasicAngleDef<T>::overlapTest(c[i*2], c[i*2+1]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+}
+
+BENCHMARK("AngleDef/overlapTest", benchOverlap<float>);
+BENCHMARK("AngleDef/overlapTest/double", benchOverlap<double>);
+
+// The batch kernels process every input pair per iteration
+template<typename T>
+static void fillBatches(BasicAngleBatch<T>& a, BasicAngleBatch<T>& b) {
+    const std::vector<BasicAngleDef<T>>& c = getCones<T>();
+    a.reset(INPUT_COUNT);
+    b.reset(INPUT_COUNT);
+    for(std::size_t i = 0; i < INPUT_COUNT; ++i) {
+        a.set(i, c[i*2]);
+        b.set(i, c[i*2+1]);
+    }
+}
+
+template<typename T>
+static void benchBatchUnion(BenchmarkState& state) {
+    BasicAngleBatch<T> a, b, r;
+    fillBatches(a, b);
+    r.reset(INPUT_COUNT);
+    while(state.keepRunning()) {
+        BasicAngleBatch<T>::angleUnion(a, b, r);
+        doNotOptimize(r);
+    }
+    state.setItemsPerIteration(INPUT_COUNT, "calls");
+}
+
+BENCHMARK("AngleBatch/angleUnion", benchBatchUnion<float>);
+BENCHMARK("AngleBatch/angleUnion/double", benchBatchUnion<double>);
+
+template<typename T>
+static void benchBatchIntersection(BenchmarkState& state) {
+    BasicAngleBatch<T> a, b, r;
+    fillBatches(a, b);
+    r.reset(INPUT_COUNT);
+    while(state.keepRunning()) {
+        BasicAngleBatch<T>::angleIntersection(a, b, r);
+        doNotOptimize(r);
+    }
+    state.setItemsPerIteration(INPUT_COUNT, "calls");
+}
+
+BENCHMARK("AngleBatch/angleIntersection", benchBatchIntersection<float>);
+BENCHMARK("AngleBatch/angleIntersection/double", benchBatchIntersection<double>);
+
+BENCHMARK("Square/squareIntersection", [](BenchmarkState& state) {
+    const std::vector<Square>& s = getSquares();
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(Square::squareIntersection(s[i*2], s[i*2+1]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+});
+
+BENCHMARK("Square/squareUnion", [](BenchmarkState& state) {
+    const std::vector<Square>& s = getSquares();
+    std::size_t i = 0;
+    while(state.keepRunning()) {
+        doNotOptimize(Square::squareUnion(s[i*2], s[i*2+1]));
+        i = (i+1)%INPUT_COUNT;
+    }
+    state.setItemsPerIteration(1, "calls");
+});
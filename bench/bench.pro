@@ -0,0 +1,26 @@
+CONFIG -= qt
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = bench
+
+TEMPLATE = app
+
+include(../core/core.pri)
+
+QMAKE_CXXFLAGS += -std=c++0x -fno-exceptions -pthread
+CONFIG(release, debug|release): DEFINES += NDEBUG
+
+# Only the header-only glm bundled with VBE is needed
+INCLUDEPATH += . ../VBE/include
+
+SOURCES += \
+    main.cpp \
+    Benchmark.cpp \
+    Maps.cpp \
+    MicroBenchmarks.cpp \
+    MacroBenchmarks.cpp
+
+HEADERS += \
+    Benchmark.hpp \
+    Maps.hpp
@@ -0,0 +1,25 @@
+#include "Benchmark.hpp"
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+static void usage() {
+    std::printf("Usage: bench [--filter=<substring>] [--min-time=<seconds>] [--csv]\n");
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double minSeconds = 0.2;
+    bool csv = false;
+    for(int i = 1; i < argc; ++i) {
+        if(std::strncmp(argv[i], "--filter=", 9) == 0) filter = argv[i] + 9;
+        else if(std::strncmp(argv[i], "--min-time=", 11) == 0) minSeconds = std::atof(argv[i] + 11);
+        else if(std::strcmp(argv[i], "--csv") == 0) csv = true;
+        else {
+            usage();
+            return 1;
+        }
+    }
+    // Unexpected allocations fail the run, so it can be used as a check
+    return Benchmark::runAll(filter, minSeconds, csv) == 0 ? 0 : 2;
+}
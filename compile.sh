@@ -23,13 +23,16 @@ function usage {
     prim "        -r"
     echo "            Rebuild all. Will remove the previous build directory"
     echo "            and recreate the symbolic links."
+    prim "        -s"
+    echo "            Build the solvers with per-phase timers and counters (CORE_STATS)."
 }
 
 REBUILD=false
 DEBUG=false
+STATS=false
 BUILD_DIR="build"
 
-while getopts ":rdh" opt; do
+while getopts ":rdsh" opt; do
   case $opt in
     r)
       REBUILD=true
@@ -38,6 +41,9 @@ while getopts ":rdh" opt; do
       DEBUG=true
       BUILD_DIR="build-debug"
       ;;
+    s)
+      STATS=true
+      ;;
     h)
       usage
       exit 1
@@ -63,12 +69,17 @@ mkdir -p $BUILD_DIR
 cd $BUILD_DIR
 prim "Running qmake..."
 
+QMAKE_CONFIG=""
+if [ $STATS = true ]; then
+    prim "SOLVER STATS ENABLED"
+    QMAKE_CONFIG="CONFIG+=core_stats"
+fi
 if [ $DEBUG = true ]; then
     prim "DEBUG BUILD"
-    qmake $PROJECT_FILE_RELATIVE_PATH -r -spec linux-g++-64 2>&1 CONFIG+=debug
+    qmake $PROJECT_FILE_RELATIVE_PATH -r -spec linux-g++-64 2>&1 CONFIG+=debug $QMAKE_CONFIG
 else
     prim "RELEASE BUILD"
-    qmake $PROJECT_FILE_RELATIVE_PATH -r -spec linux-g++-64 2>&1
+    qmake $PROJECT_FILE_RELATIVE_PATH -r -spec linux-g++-64 2>&1 $QMAKE_CONFIG
 fi
 
 if [ ! -L "game/assets" ]; then
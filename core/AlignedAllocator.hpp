@@ -0,0 +1,48 @@
+#ifndef ALIGNEDALLOCATOR_HPP
+#define ALIGNEDALLOCATOR_HPP
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+
+#define CACHE_LINE 64
+
+// Called for every block AlignedAllocator hands out, if set. Memory from
+// posix_memalign never goes through operator new, so tools that count heap
+// allocations install this to see these too. Set it before any thread uses
+// the allocator.
+typedef void (*AlignedAllocationHook)();
+inline AlignedAllocationHook& getAlignedAllocationHook() {
+    static AlignedAllocationHook hook = nullptr;
+    return hook;
+}
+
+// Allocator that hands out cache-line aligned blocks, so that per-cell
+// arrays never share their first or last line with unrelated data.
+template<typename T, std::size_t Alignment = CACHE_LINE>
+class AlignedAllocator {
+    public:
+        typedef T value_type;
+        template<typename U> struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+        AlignedAllocator() {}
+        template<typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+        T* allocate(std::size_t n) {
+            if(AlignedAllocationHook hook = getAlignedAllocationHook()) hook();
+            void* p = nullptr;
+            if(posix_memalign(&p, Alignment, n*sizeof(T) == 0 ? Alignment : n*sizeof(T)) != 0)
+                std::abort();
+            return static_cast<T*>(p);
+        }
+        void deallocate(T* p, std::size_t) {
+            std::free(p);
+        }
+};
+
+template<typename T, typename U, std::size_t A>
+bool operator==(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return true; }
+template<typename T, typename U, std::size_t A>
+bool operator!=(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return false; }
+
+#endif //ALIGNEDALLOCATOR_HPP
@@ -0,0 +1,385 @@
+#include "AngleBatch.hpp"
+#include <cmath>
+
+#define EPSILON ConePrecision<T>::epsilon()
+
+#if defined(__GNUC__)
+    #define KERNEL_INLINE inline __attribute__((always_inline))
+#else
+    #define KERNEL_INLINE inline
+#endif
+
+// Runtime dispatch between SSE2 (the x86-64 baseline), AVX2 and AVX-512
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define KERNEL_DISPATCH
+#endif
+
+// The kernels below are the AngleDef operations rewritten without early
+// returns: every case is computed and the right one is picked with selects,
+// so a whole block of lanes goes through the same instructions and the
+// compiler can vectorize it. Every expression is evaluated in the same order
+// as in AngleDef.cpp (and as glm does it), which keeps results bit for bit
+// identical as long as the compiler doesn't fuse multiply-adds. They are
+// written once for both lane types, T being float or double.
+
+namespace {
+
+template<typename T>
+struct Vec {
+    T x, y, z;
+};
+
+template<typename T>
+struct Lane {
+    Vec<T> dir;
+    T h;
+    int full;
+};
+
+template<typename T>
+struct Input {
+    const T* x;
+    const T* y;
+    const T* z;
+    const T* h;
+    const int* full;
+};
+
+template<typename T>
+struct Output {
+    T* x;
+    T* y;
+    T* z;
+    T* h;
+    int* full;
+};
+
+template<typename T>
+KERNEL_INLINE Vec<T> add(const Vec<T>& a, const Vec<T>& b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+template<typename T>
+KERNEL_INLINE Vec<T> sub(const Vec<T>& a, const Vec<T>& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+template<typename T>
+KERNEL_INLINE Vec<T> mul(const Vec<T>& a, T s) { return {a.x*s, a.y*s, a.z*s}; }
+template<typename T>
+KERNEL_INLINE Vec<T> div(const Vec<T>& a, T s) { return {a.x/s, a.y/s, a.z/s}; }
+template<typename T>
+KERNEL_INLINE Vec<T> neg(const Vec<T>& a) { return {-a.x, -a.y, -a.z}; }
+template<typename T>
+KERNEL_INLINE T dot(const Vec<T>& a, const Vec<T>& b) { return a.x*b.x + a.y*b.y + a.z*b.z; }
+template<typename T>
+KERNEL_INLINE T length(const Vec<T>& a) { return std::sqrt(dot(a, a)); }
+template<typename T>
+KERNEL_INLINE Vec<T> normalize(const Vec<T>& a) { return mul(a, T(1)/std::sqrt(dot(a, a))); }
+template<typename T>
+KERNEL_INLINE Vec<T> cross(const Vec<T>& a, const Vec<T>& b) {
+    return {a.y*b.z - b.y*a.z, a.z*b.x - b.z*a.x, a.x*b.y - b.x*a.y};
+}
+template<typename T>
+KERNEL_INLINE bool sameDir(const Vec<T>& a, const Vec<T>& b) {
+    return (std::abs(a.x - b.x) < EPSILON) & (std::abs(a.y - b.y) < EPSILON) & (std::abs(a.z - b.z) < EPSILON);
+}
+template<typename T>
+KERNEL_INLINE Lane<T> select(bool c, const Lane<T>& a, const Lane<T>& b) {
+    return {{c ? a.dir.x : b.dir.x, c ? a.dir.y : b.dir.y, c ? a.dir.z : b.dir.z}, c ? a.h : b.h, c ? a.full : b.full};
+}
+
+template<typename T>
+KERNEL_INLINE Lane<T> load(const Input<T>& in, std::size_t i) {
+    return {{in.x[i], in.y[i], in.z[i]}, in.h[i], in.full[i]};
+}
+
+// BasicAngleDef::overlapTest without the full cone checks
+template<typename T>
+KERNEL_INLINE int overlapLane(const Lane<T>& a, const Lane<T>& b) {
+    Vec<T> dir1 = b.dir;
+    Vec<T> dir2 = a.dir;
+    Vec<T> side = mul(cross(normalize(cross(dir1, dir2)), dir1), b.h);
+    Vec<T> p1 = sub(dir1, side);
+    Vec<T> p2 = add(dir1, side);
+    T l1 = dot(p1, dir2);
+    T l2 = dot(p2, dir2);
+    T r1 = length(sub(p1, mul(dir2, l1)));
+    T r2 = length(sub(p2, mul(dir2, l2)));
+    int result = int((l1 > T(0)) & (r1/l1 < a.h + EPSILON)) + int((l2 > T(0)) & (r2/l2 < a.h + EPSILON));
+    int same = a.h >= b.h ? BasicAngleDef<T>::CONTAINS : BasicAngleDef<T>::NONE;
+    return sameDir(dir1, dir2) ? same : result;
+}
+
+template<typename T>
+KERNEL_INLINE Lane<T> unionLane(const Lane<T>& a, const Lane<T>& b) {
+    const Lane<T> full = {{T(0), T(0), T(0)}, T(0), 1};
+    int acb = overlapLane(a, b);
+    int bca = overlapLane(b, a);
+    // General case
+    Vec<T> dir1 = a.dir;
+    Vec<T> dir2 = b.dir;
+    Vec<T> c = normalize(cross(dir1, dir2));
+    Vec<T> dir3 = normalize(add(mul(neg(cross(c, dir1)), a.h), dir1));
+    Vec<T> dir4 = normalize(add(mul(neg(cross(neg(c), dir2)), b.h), dir2));
+    Vec<T> d = normalize(add(dir3, dir4));
+    Lane<T> r = {d, length(sub(d, div(dir3, dot(dir3, d)))), 0};
+    // Special cases, from the last one AngleDef checks to the first
+    r = select(!(dot(add(dir1, dir2), d) > T(0)), full, r);
+    r = select(sameDir(dir1, dir2), select(a.h > b.h, a, b), r);
+    r = select((b.h >= a.h) & (bca == BasicAngleDef<T>::CONTAINS), b, r);
+    r = select((a.h >= b.h) & (acb == BasicAngleDef<T>::CONTAINS), a, r);
+    r = select(b.h == T(0), a, r);
+    r = select(a.h == T(0), b, r);
+    r = select((a.full | b.full) != 0, full, r);
+    return r;
+}
+
+template<typename T>
+KERNEL_INLINE Lane<T> intersectionLane(const Lane<T>& a, const Lane<T>& b) {
+    const Lane<T> empty = {{T(0), T(0), T(0)}, T(0), 0};
+    // Only the bigger cone is tested against the smaller one
+    bool aBig = a.h >= b.h;
+    int overlap = overlapLane(select(aBig, a, b), select(aBig, b, a));
+    // General case
+    Vec<T> dir1 = a.dir;
+    Vec<T> dir2 = b.dir;
+    Vec<T> c = normalize(cross(dir1, dir2));
+    Vec<T> dir3 = normalize(add(mul(cross(c, dir1), a.h), dir1));
+    Vec<T> dir4 = normalize(add(mul(cross(neg(c), dir2), b.h), dir2));
+    Vec<T> d = normalize(add(dir3, dir4));
+    T tangent = length(sub(d, div(dir3, dot(dir3, d))));
+    Lane<T> r = {d, tangent, 0};
+    // Special cases, from the last one AngleDef checks to the first
+    r = select(std::abs(tangent) < EPSILON, empty, r);
+    r = select(sameDir(dir1, dir2), select(a.h > b.h, b, a), r);
+    r = select(overlap == BasicAngleDef<T>::NONE, empty, r);
+    r = select(overlap == BasicAngleDef<T>::CONTAINS, select(aBig, b, a), r);
+    r = select((a.h == T(0)) | (b.h == T(0)), empty, r);
+    r = select(a.full != 0, b, r);
+    r = select(b.full != 0, a, r);
+    return r;
+}
+
+// Each block of W lanes is computed into locals first, so the result can
+// alias the inputs without the compiler having to check for it
+template<typename T, int W>
+KERNEL_INLINE void runUnion(std::size_t n, const Input<T>& a, const Input<T>& b, const Output<T>& out) {
+    for(std::size_t i = 0; i < n; i += W) {
+        T x[W], y[W], z[W], h[W];
+        int full[W];
+        for(int l = 0; l < W; ++l) {
+            Lane<T> r = unionLane(load(a, i+l), load(b, i+l));
+            x[l] = r.dir.x; y[l] = r.dir.y; z[l] = r.dir.z; h[l] = r.h; full[l] = r.full;
+        }
+        for(int l = 0; l < W; ++l) {
+            out.x[i+l] = x[l]; out.y[i+l] = y[l]; out.z[i+l] = z[l]; out.h[i+l] = h[l]; out.full[i+l] = full[l];
+        }
+    }
+}
+
+template<typename T, int W>
+KERNEL_INLINE void runIntersection(std::size_t n, const Input<T>& a, const Input<T>& b, const Output<T>& out) {
+    for(std::size_t i = 0; i < n; i += W) {
+        T x[W], y[W], z[W], h[W];
+        int full[W];
+        for(int l = 0; l < W; ++l) {
+            Lane<T> r = intersectionLane(load(a, i+l), load(b, i+l));
+            x[l] = r.dir.x; y[l] = r.dir.y; z[l] = r.dir.z; h[l] = r.h; full[l] = r.full;
+        }
+        for(int l = 0; l < W; ++l) {
+            out.x[i+l] = x[l]; out.y[i+l] = y[l]; out.z[i+l] = z[l]; out.h[i+l] = h[l]; out.full[i+l] = full[l];
+        }
+    }
+}
+
+template<typename T, int W>
+KERNEL_INLINE void runOverlap(std::size_t n, const Input<T>& a, const Input<T>& b, int* out) {
+    for(std::size_t i = 0; i < n; i += W)
+        for(int l = 0; l < W; ++l) {
+            Lane<T> la = load(a, i+l);
+            Lane<T> lb = load(b, i+l);
+            int r = overlapLane(la, lb);
+            r = lb.full ? int(BasicAngleDef<T>::NONE) : r;
+            out[i+l] = la.full ? int(BasicAngleDef<T>::CONTAINS) : r;
+        }
+}
+
+template<typename T>
+struct Kernels {
+    const char* name;
+    int lanes;
+    void (*unite)(std::size_t, const Input<T>&, const Input<T>&, const Output<T>&);
+    void (*intersect)(std::size_t, const Input<T>&, const Input<T>&, const Output<T>&);
+    void (*overlap)(std::size_t, const Input<T>&, const Input<T>&, int*);
+};
+
+// BYTES is the register width, so the blocks hold half as many doubles as
+// floats
+#define DEFINE_KERNELS(NAME, TARGET, BYTES) \
+    template<typename T> \
+    TARGET void unite##NAME(std::size_t n, const Input<T>& a, const Input<T>& b, const Output<T>& out) { runUnion<T, BYTES/sizeof(T)>(n, a, b, out); } \
+    template<typename T> \
+    TARGET void intersect##NAME(std::size_t n, const Input<T>& a, const Input<T>& b, const Output<T>& out) { runIntersection<T, BYTES/sizeof(T)>(n, a, b, out); } \
+    template<typename T> \
+    TARGET void overlap##NAME(std::size_t n, const Input<T>& a, const Input<T>& b, int* out) { runOverlap<T, BYTES/sizeof(T)>(n, a, b, out); } \
+    template<typename T> \
+    Kernels<T> kernels##NAME() { \
+        Kernels<T> k = {#NAME, int(BYTES/sizeof(T)), unite##NAME<T>, intersect##NAME<T>, overlap##NAME<T>}; \
+        return k; \
+    }
+
+// Every kernel set of the build, the preferred one first, and which of them
+// this CPU can run. The one in use is the first supported one unless a test
+// picks another.
+template<typename T>
+struct KernelList {
+    enum {
+        MAX_SETS = 3
+    };
+
+    void add(const Kernels<T>& k, bool isSupported) {
+        sets[count] = k;
+        supported[count] = isSupported;
+        ++count;
+    }
+
+    Kernels<T> sets[MAX_SETS];
+    bool supported[MAX_SETS];
+    int count = 0;
+    int current = 0;
+};
+
+#ifdef KERNEL_DISPATCH
+DEFINE_KERNELS(SSE2, , 16)
+DEFINE_KERNELS(AVX2, __attribute__((target("avx2"))), 32)
+DEFINE_KERNELS(AVX512, __attribute__((target("avx512f,prefer-vector-width=512"))), 64)
+
+template<typename T>
+KernelList<T> listKernels() {
+    __builtin_cpu_init();
+    KernelList<T> list;
+    list.add(kernelsAVX512<T>(), __builtin_cpu_supports("avx512f"));
+    list.add(kernelsAVX2<T>(), __builtin_cpu_supports("avx2"));
+    list.add(kernelsSSE2<T>(), true);
+    return list;
+}
+#else
+DEFINE_KERNELS(Generic, , 16)
+
+template<typename T>
+KernelList<T> listKernels() {
+    KernelList<T> list;
+    list.add(kernelsGeneric<T>(), true);
+    return list;
+}
+#endif
+
+template<typename T>
+KernelList<T>& getKernelList() {
+    static KernelList<T> list = []() {
+        KernelList<T> l = listKernels<T>();
+        while(!l.supported[l.current]) ++l.current;
+        return l;
+    }();
+    return list;
+}
+
+template<typename T>
+const Kernels<T>& getKernels() {
+    const KernelList<T>& list = getKernelList<T>();
+    return list.sets[list.current];
+}
+
+template<typename T>
+Input<T> getInput(const T* x, const T* y, const T* z, const T* h, const int* full) {
+    return {x, y, z, h, full};
+}
+
+}
+
+template<typename T>
+BasicAngleBatch<T>::BasicAngleBatch() {
+}
+
+template<typename T>
+BasicAngleBatch<T>::~BasicAngleBatch() {
+}
+
+template<typename T>
+void BasicAngleBatch<T>::reset(std::size_t count) {
+    this->count = count;
+    std::size_t padded = (count + MAX_LANES - 1)/MAX_LANES*MAX_LANES;
+    dirX.assign(padded, T(0));
+    dirY.assign(padded, T(0));
+    dirZ.assign(padded, T(0));
+    tanHalf.assign(padded, T(0));
+    full.assign(padded, 0);
+}
+
+template<typename T>
+void BasicAngleBatch<T>::angleUnion(const BasicAngleBatch& a, const BasicAngleBatch& b, BasicAngleBatch& result) {
+    CORE_ASSERT(a.size() == b.size() && a.size() == result.size(), "Batches must have the same size");
+    Output<T> out = {result.dirX.data(), result.dirY.data(), result.dirZ.data(), result.tanHalf.data(), result.full.data()};
+    getKernels<T>().unite(result.dirX.size(),
+                          getInput(a.getDirX(), a.getDirY(), a.getDirZ(), a.getTanHalf(), a.getFull()),
+                          getInput(b.getDirX(), b.getDirY(), b.getDirZ(), b.getTanHalf(), b.getFull()),
+                          out);
+}
+
+template<typename T>
+void BasicAngleBatch<T>::angleIntersection(const BasicAngleBatch& a, const BasicAngleBatch& b, BasicAngleBatch& result) {
+    CORE_ASSERT(a.size() == b.size() && a.size() == result.size(), "Batches must have the same size");
+    Output<T> out = {result.dirX.data(), result.dirY.data(), result.dirZ.data(), result.tanHalf.data(), result.full.data()};
+    getKernels<T>().intersect(result.dirX.size(),
+                              getInput(a.getDirX(), a.getDirY(), a.getDirZ(), a.getTanHalf(), a.getFull()),
+                              getInput(b.getDirX(), b.getDirY(), b.getDirZ(), b.getTanHalf(), b.getFull()),
+                              out);
+}
+
+template<typename T>
+void BasicAngleBatch<T>::overlapTest(const BasicAngleBatch& a, const BasicAngleBatch& b, std::vector<int>& result) {
+    CORE_ASSERT(a.size() == b.size(), "Batches must have the same size");
+    result.resize(a.dirX.size());
+    getKernels<T>().overlap(a.dirX.size(),
+                            getInput(a.getDirX(), a.getDirY(), a.getDirZ(), a.getTanHalf(), a.getFull()),
+                            getInput(b.getDirX(), b.getDirY(), b.getDirZ(), b.getTanHalf(), b.getFull()),
+                            result.data());
+    result.resize(a.size());
+}
+
+template<typename T>
+const char* BasicAngleBatch<T>::getKernelName() {
+    return getKernels<T>().name;
+}
+
+template<typename T>
+int BasicAngleBatch<T>::getLaneCount() {
+    return getKernels<T>().lanes;
+}
+
+template<typename T>
+int BasicAngleBatch<T>::getKernelCount() {
+    return getKernelList<T>().count;
+}
+
+template<typename T>
+const char* BasicAngleBatch<T>::getKernelName(int kernel) {
+    CORE_ASSERT(kernel >= 0 && kernel < getKernelCount(), "No such kernel");
+    return getKernelList<T>().sets[kernel].name;
+}
+
+template<typename T>
+bool BasicAngleBatch<T>::isKernelSupported(int kernel) {
+    CORE_ASSERT(kernel >= 0 && kernel < getKernelCount(), "No such kernel");
+    return getKernelList<T>().supported[kernel];
+}
+
+template<typename T>
+void BasicAngleBatch<T>::useKernel(int kernel) {
+    KernelList<T>& list = getKernelList<T>();
+    if(kernel < 0) {
+        list.current = 0;
+        while(!list.supported[list.current]) ++list.current;
+        return;
+    }
+    CORE_ASSERT(kernel < list.count && list.supported[kernel], "Kernel can't run on this CPU");
+    list.current = kernel;
+}
+
+template class BasicAngleBatch<float>;
+template class BasicAngleBatch<double>;
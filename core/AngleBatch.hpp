@@ -0,0 +1,81 @@
+#ifndef ANGLEBATCH_HPP
+#define ANGLEBATCH_HPP
+
+#include "AngleDef.hpp"
+#include "AlignedAllocator.hpp"
+
+// Structure-of-arrays list of cones for the batch versions of AngleDef's
+// operations. The arrays are padded to a whole number of MAX_LANES so the
+// kernels never need a scalar tail. T is the lane type, float or double.
+template<typename T>
+class BasicAngleBatch {
+    public:
+        enum {
+            MAX_LANES = 16
+        };
+        typedef BasicAngleDef<T> Angle;
+
+        BasicAngleBatch();
+        ~BasicAngleBatch();
+
+        // Sets the number of cones and empties all of them
+        void reset(std::size_t count);
+        std::size_t size() const { return count; }
+
+        Angle get(std::size_t i) const {
+            return {{dirX[i], dirY[i], dirZ[i]}, tanHalf[i], full[i] != 0};
+        }
+        void set(std::size_t i, const Angle& a) {
+            dirX[i] = a.dir.x;
+            dirY[i] = a.dir.y;
+            dirZ[i] = a.dir.z;
+            tanHalf[i] = a.halfAngle;
+            full[i] = a.full ? 1 : 0;
+        }
+
+        const T* getDirX() const { return dirX.data(); }
+        const T* getDirY() const { return dirY.data(); }
+        const T* getDirZ() const { return dirZ.data(); }
+        const T* getTanHalf() const { return tanHalf.data(); }
+        const int* getFull() const { return full.data(); }
+
+        // Same as calling the BasicAngleDef version for every i, bit for
+        // bit. result may be one of the inputs, and all of them must have the
+        // same size.
+        static void angleUnion(const BasicAngleBatch& a, const BasicAngleBatch& b, BasicAngleBatch& result);
+        static void angleIntersection(const BasicAngleBatch& a, const BasicAngleBatch& b, BasicAngleBatch& result);
+        static void overlapTest(const BasicAngleBatch& a, const BasicAngleBatch& b, std::vector<int>& result);
+
+        // Instruction set the kernels were picked for on this CPU, and how
+        // many lanes of T its registers hold
+        static const char* getKernelName();
+        static int getLaneCount();
+
+        // Every kernel set compiled into this build, the preferred one
+        // first. Only the ones this CPU supports can be used.
+        static int getKernelCount();
+        static const char* getKernelName(int kernel);
+        static bool isKernelSupported(int kernel);
+        // Makes every batch operation use that kernel set instead of the one
+        // picked for this CPU, or go back to it if kernel is negative. For
+        // tests that compare each set against BasicAngleDef; not to be called
+        // while other threads use batches.
+        static void useKernel(int kernel);
+
+    private:
+        typedef std::vector<T, AlignedAllocator<T>> FloatArray;
+        typedef std::vector<int, AlignedAllocator<int>> IntArray;
+
+        std::size_t count = 0;
+        FloatArray dirX;
+        FloatArray dirY;
+        FloatArray dirZ;
+        FloatArray tanHalf;
+        IntArray full;
+};
+
+// Only these two are instantiated, in AngleBatch.cpp
+typedef BasicAngleBatch<float> AngleBatch;
+typedef BasicAngleBatch<double> AngleBatchDouble;
+
+#endif //ANGLEBATCH_HPP
@@ -0,0 +1,178 @@
+#include "AngleDef.hpp"
+
+#define EPSILON ConePrecision<T>::epsilon()
+
+template<typename T>
+typename BasicAngleDef<T>::Overlap BasicAngleDef<T>::overlapTest(const BasicAngleDef& a, const BasicAngleDef& b) {
+    if(a.full) return CONTAINS;
+    if(b.full) return NONE;
+    Vec3 dir1 = b.dir;
+    Vec3 dir2 = a.dir;
+    // if dir1 == dir2 then just check the halfangles
+    if(glm::epsilonEqual(dir1, dir2, EPSILON) == vec3b(true)) {
+        if(a.halfAngle >= b.halfAngle)
+            return CONTAINS;
+        return NONE;
+    }
+    // side is the vector that orthogonally points away from dir1. With a
+    // magnitude of halfangle tangent
+    Vec3 side = glm::cross(glm::normalize(glm::cross(dir1, dir2)), dir1)*b.halfAngle;
+    // p1 and p2 are the "extremes" of b's angle
+    Vec3 p1 = dir1-side;
+    Vec3 p2 = dir1+side;
+    // l1 and l2 are the length of the vector that results from
+    // projecting p1 and p2 onto dir2
+    T l1 = glm::dot(p1, dir2);
+    T l2 = glm::dot(p2, dir2);
+    // r1 and r2 are the rejection vectors of said projection
+    T r1 = glm::length(p1-dir2*l1);
+    T r2 = glm::length(p2-dir2*l2);
+    // Return value explanation
+    // NONE: this angle doesn't contain any half of the other,
+    // so it can both mean it's fully inside it or that they don't
+    // overlap at all
+    // PARTIAL: this angle contains one of the ends of the other
+    // or is right next to the other by a negligible distance
+    // CONTAINS: this angle fully contains the other
+    int result = 0;
+    if(l1 > T(0) && r1/l1 < a.halfAngle+EPSILON) result++;
+    if(l2 > T(0) && r2/l2 < a.halfAngle+EPSILON) result++;
+    return static_cast<Overlap>(result);
+}
+
+template<typename T>
+BasicAngleDef<T> BasicAngleDef<T>::angleUnion(const BasicAngleDef& a, const BasicAngleDef& b) {
+    // if any of both are full, union will be full
+    if(a.full || b.full)
+        return {Vec3(T(0)), T(0), true};
+    // if one of them is null, return the other
+    if(a.halfAngle == T(0))
+        return b;
+    if(b.halfAngle == T(0))
+        return a;
+    // if a contains b, result is a
+    Overlap acb = INVALID;
+    if(a.halfAngle >= b.halfAngle) {
+        acb = overlapTest(a, b);
+        if(acb == CONTAINS)
+            return a;
+    }
+    // and viceversa
+    Overlap bca = INVALID;
+    if(b.halfAngle >= a.halfAngle) {
+        bca = overlapTest(b, a);
+        if(bca == CONTAINS)
+            return b;
+    }
+    // General case. We compute the ends of the intersection
+    // by rotating each cone direction away from the other direction
+    // by their own half angle. This is done avoiding trigonometry,
+    Vec3 dir1 = a.dir;
+    Vec3 dir2 = b.dir;
+    // if dir1 == dir2 then just check the halfangles
+    if(glm::epsilonEqual(dir1, dir2, EPSILON) == vec3b(true)) {
+        if(a.halfAngle > b.halfAngle)
+            return a;
+        return b;
+    }
+    // cross will point opposite directions depending on whether
+    // dir1 is on the clockwise side of dir2 or the other way around,
+    // in the context of the plane given by (0,0,0), dir1 and dir2,
+    // where dir1 and dir2 are coplanar. cross will point orthogonally away
+    // from that plane one side or the other
+    Vec3 cross = glm::normalize(glm::cross(dir1, dir2));
+    // dir3 is obtained by rotating dir1 away from dir2 by a's halfangle.
+    // the cross product of (cross, dir1) tells us which direction is
+    // towards dir2.
+    Vec3 dir3 = glm::normalize(-glm::cross(cross, dir1)*a.halfAngle+dir1);
+    // dir4 is obtained by rotating dir2 away from dir1 by b's halfangle.
+    // the cross product of (-cross, dir2) tells us which direction is
+    // towards dir1. We negate cross because -cross(dir1, dir2) is the same
+    // as cross(dir2, dir1)
+    Vec3 dir4 = glm::normalize(-glm::cross(-cross, dir2)*b.halfAngle+dir2);
+    // d is the direction of the union angle
+    Vec3 d = glm::normalize(dir3 + dir4);
+    // if dot(dir1+dir2, d) < 0, the union angle is > 180 deg. Opposite
+    // directions have no cross product to normalize and leave d NaN, and
+    // their union is > 180 deg too
+    if(!(glm::dot(dir1+dir2, d) > T(0))) return {Vec3(T(0)), T(0), true};
+    // we compute the tangent of the new halfangle by scaling one of the
+    // outer vectors by the inverse of it's projection onto the new
+    // angle's direction, and computing the length of the vector that
+    // results from going from the central direction to this scaled outer direction
+    return {d, glm::length(d-(dir3/glm::dot(dir3,d))), false};
+}
+
+template<typename T>
+BasicAngleDef<T> BasicAngleDef<T>::angleIntersection(const BasicAngleDef& a, const BasicAngleDef& b) {
+    // if b is full, intersection will be a
+    if(b.full)
+        return {a.dir, a.halfAngle, a.full};
+    // if a is full, intersection will be b
+    if(a.full)
+        return {b.dir, b.halfAngle, b.full};
+    // if any of both are null, intersection will be empty
+    if(a.halfAngle == T(0) || b.halfAngle == T(0))
+        return {Vec3(T(0)), T(0), false};
+    Overlap acb = INVALID;
+    // if a contains b, intersection will equal b
+    if(a.halfAngle >= b.halfAngle) {
+        acb = overlapTest(a, b);
+        if(acb == CONTAINS)
+            return {b.dir, b.halfAngle, b.full};
+    }
+    // if a is not bigger than b...
+    if(acb == INVALID) {
+        Overlap bca = overlapTest(b, a);
+        // b contains a, return a
+        if(bca == CONTAINS)
+            return {a.dir, a.halfAngle, a.full};
+        // they don't overlap, return empty
+        if(bca == NONE)
+            return {Vec3(T(0)), T(0), false};
+    }
+    else if(acb == NONE)
+        // if a is bigger than B but does not contain it, return empty
+        return {Vec3(T(0)), T(0), false};
+    // General case. We compute the ends of the intersection
+    // by rotating each cone direction towards the other direction
+    // by their own half angle. This is done avoiding trigonometry,
+    Vec3 dir1 = a.dir;
+    Vec3 dir2 = b.dir;
+    // if dir1 == dir2 then just check the halfangles
+    if(glm::epsilonEqual(dir1, dir2, EPSILON) == vec3b(true)) {
+        if(a.halfAngle > b.halfAngle)
+            return b;
+        return a;
+    }
+    // cross will point opposite directions depending on whether
+    // dir1 is on the clockwise side of dir2 or the other way around,
+    // in the context of the plane given by (0,0,0), dir1 and dir2,
+    // where dir1 and dir2 are coplanar. cross will point orthogonally away
+    // from that plane one side or the other
+    Vec3 cross = glm::normalize(glm::cross(dir1, dir2));
+    // dir3 is obtained by rotating dir1 towards dir2 by a's halfangle.
+    // the cross product of (cross, dir1) tells us which direction is
+    // towards dir2.
+    Vec3 dir3 = glm::normalize(glm::cross(cross, dir1)*a.halfAngle+dir1);
+    // dir4 is obtained by rotating dir2 towards dir1 by b's halfangle.
+    // the cross product of (-cross, dir2) tells us which direction is
+    // towards dir1. We negate cross because -cross(dir1, dir2) is the same
+    // as cross(dir2, dir1)
+    Vec3 dir4 = glm::normalize(glm::cross(-cross, dir2)*b.halfAngle+dir2);
+    // d is the direction of the intersection angle
+    Vec3 d = glm::normalize(dir3 + dir4);
+    // we compute the tangent of the new halfangle by scaling one of the
+    // outer vectors by the inverse of it's projection onto the new
+    // angle's direction, and computing the length of the vector that
+    // results from going from the central direction to this scaled outer direction
+    T tangent = glm::length(d-(dir3/glm::dot(dir3,d)));
+    // this handles the imprecision-caused edge case where an angle is created with
+    // a very small tangent
+    if(glm::epsilonEqual(tangent, T(0), EPSILON))
+        return {Vec3(T(0)), T(0), false};
+    return {d, tangent, false};
+}
+
+template struct BasicAngleDef<float>;
+template struct BasicAngleDef<double>;
@@ -0,0 +1,56 @@
+#ifndef ANGLEDEF_HPP
+#define ANGLEDEF_HPP
+
+#include "CoreCommons.hpp"
+
+// Types and tolerances of the cone math for each precision it is built for.
+// Float is what everything uses by default. Double keeps the thin cones of
+// cells far from the origin apart, at the cost of twice the memory and half
+// the SIMD lanes.
+template<typename T>
+struct ConePrecision;
+
+template<>
+struct ConePrecision<float> {
+    typedef vec2f Vec2;
+    typedef vec3f Vec3;
+    // Used by the cone operations
+    static float epsilon() { return 0.00001f; }
+    // Used by cone fitting and when comparing results
+    static float fineEpsilon() { return 0.000001f; }
+};
+
+template<>
+struct ConePrecision<double> {
+    typedef vec2d Vec2;
+    typedef vec3d Vec3;
+    static double epsilon() { return 1e-11; }
+    static double fineEpsilon() { return 1e-12; }
+};
+
+template<typename T>
+struct BasicAngleDef {
+    typedef T Scalar;
+    typedef typename ConePrecision<T>::Vec3 Vec3;
+
+    enum Overlap {
+        INVALID = -1,
+        NONE = 0,
+        PARTIAL,
+        CONTAINS
+    };
+
+    static BasicAngleDef angleUnion(const BasicAngleDef& a, const BasicAngleDef& b);
+    static BasicAngleDef angleIntersection(const BasicAngleDef& a, const BasicAngleDef& b);
+    static Overlap overlapTest(const BasicAngleDef& a, const BasicAngleDef& b);
+
+    Vec3 dir;
+    T halfAngle; //stored as tan(half angle)
+    bool full;
+};
+
+// Only these two are instantiated, in AngleDef.cpp
+typedef BasicAngleDef<float> AngleDef;
+typedef BasicAngleDef<double> AngleDefDouble;
+
+#endif //ANGLEDEF_HPP
@@ -0,0 +1,41 @@
+#include "BatchSolver.hpp"
+
+BatchSolver::BatchSolver(const BlockerGrid& blockers, unsigned int threadCount) :
+    blockers(blockers), pool(threadCount), solvers(pool.getThreadCount()) {
+}
+
+BatchSolver::~BatchSolver() {
+}
+
+void BatchSolver::solve(const std::vector<vec3i>& origins, std::vector<BitSet>& results) {
+    results.resize(origins.size());
+    vec3i size = blockers.getSize();
+    faceCones.update(volumetric ? size : vec3i(size.x, size.y, 1), volumetric ? 3 : 2, genMode2D, approxMode, &pool);
+    for(ConeSolver& s : solvers) {
+        s.genMode2D = genMode2D;
+        s.approxMode = approxMode;
+        s.volumetric = volumetric;
+        s.sparseFrontier = sparseFrontier;
+        s.sharedFaceCones = &faceCones;
+    }
+    // The solvers share the grid, so it can't be left to the first of them
+    if(sparseFrontier) blockers.prepareBricks();
+    // Lookups and inserts stay on this thread, only the solves are spread
+    pending.clear();
+    for(std::size_t i = 0; i < origins.size(); ++i) {
+        const BitSet* cached = cache ? cache->find(blockers, origins[i]) : nullptr;
+        if(cached) results[i] = *cached;
+        else pending.push_back(int(i));
+    }
+    pool.parallelFor(pending.size(), 1, [&](int begin, int end, int worker) {
+        ConeSolver& s = solvers[worker];
+        for(int j = begin; j < end; ++j) {
+            int i = pending[j];
+            s.solve(blockers, origins[i]);
+            s.getVisible(results[i]);
+        }
+    });
+    if(cache)
+        for(int i : pending)
+            cache->insert(blockers, origins[i], results[i]);
+}
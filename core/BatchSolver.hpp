@@ -0,0 +1,44 @@
+#ifndef BATCHSOLVER_HPP
+#define BATCHSOLVER_HPP
+
+#include "ConeSolver.hpp"
+#include "ThreadPool.hpp"
+#include "VisibilityCache.hpp"
+
+// Field of view for many origins on the same static blocker map. Origins are
+// fanned out over a thread pool, every worker keeps its own ConeSolver (and
+// so its cone buffer) alive across origins and batches, and the blockers and
+// face cones are shared read-only by all of them.
+class BatchSolver {
+    public:
+        BatchSolver(const BlockerGrid& blockers, unsigned int threadCount = 0);
+        ~BatchSolver();
+
+        // results[i] ends up holding the cells visible from origins[i],
+        // indexed like the blocker grid (x + sizeX*(y + sizeY*z))
+        void solve(const std::vector<vec3i>& origins, std::vector<BitSet>& results);
+
+        unsigned int getThreadCount() const { return pool.getThreadCount(); }
+        const FaceConeTable& getFaceCones() const { return faceCones; }
+
+        // Same meaning as the ConeSolver settings
+        bool genMode2D = false;
+        bool approxMode = false;
+        bool volumetric = false;
+        bool sparseFrontier = false;
+        // If set, origins found in the cache aren't solved again, and the
+        // ones that are solved get added to it. The cache must only be used
+        // with these settings and blockers, and be told about every edit to
+        // them. Not owned.
+        VisibilityCache* cache = nullptr;
+
+    private:
+        const BlockerGrid& blockers;
+        ThreadPool pool;
+        std::vector<ConeSolver> solvers;
+        FaceConeTable faceCones;
+        // Indices of the origins that weren't in the cache
+        std::vector<int> pending;
+};
+
+#endif //BATCHSOLVER_HPP
@@ -0,0 +1,43 @@
+#include "BitSet.hpp"
+
+BitSet::BitSet() {
+}
+
+BitSet::BitSet(std::size_t size) {
+    reset(size);
+}
+
+BitSet::~BitSet() {
+}
+
+void BitSet::reset(std::size_t size) {
+    bits = size;
+    words.assign((size + 63) >> 6, 0);
+}
+
+void BitSet::clear() {
+    std::fill(words.begin(), words.end(), 0);
+}
+
+void BitSet::clear(std::size_t begin, std::size_t end) {
+    CORE_ASSERT(begin <= end && end <= bits, "Bit range out of bounds");
+    if(begin == end) return;
+    std::size_t first = begin >> 6;
+    std::size_t last = (end - 1) >> 6;
+    std::uint64_t head = ~std::uint64_t(0) << (begin & 63);
+    std::uint64_t tail = ~std::uint64_t(0) >> (63 - ((end - 1) & 63));
+    if(first == last) {
+        words[first] &= ~(head & tail);
+        return;
+    }
+    words[first] &= ~head;
+    std::fill(words.begin() + first + 1, words.begin() + last, 0);
+    words[last] &= ~tail;
+}
+
+std::size_t BitSet::count() const {
+    std::size_t c = 0;
+    for(std::uint64_t w : words)
+        c += __builtin_popcountll(w);
+    return c;
+}
@@ -0,0 +1,46 @@
+#ifndef BITSET_HPP
+#define BITSET_HPP
+
+#include "CoreCommons.hpp"
+#include "AlignedAllocator.hpp"
+#include <cstdint>
+
+// Runtime sized, packed set of bits backed by 64 bit words
+class BitSet {
+    public:
+        BitSet();
+        BitSet(std::size_t size);
+        ~BitSet();
+
+        // Resizes the set and clears every bit
+        void reset(std::size_t size);
+        void clear();
+        // Clears the bits in [begin, end)
+        void clear(std::size_t begin, std::size_t end);
+
+        std::size_t size() const { return bits; }
+        bool test(std::size_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+        void set(std::size_t i) { words[i >> 6] |= std::uint64_t(1) << (i & 63); }
+        void unset(std::size_t i) { words[i >> 6] &= ~(std::uint64_t(1) << (i & 63)); }
+        void assign(std::size_t i, bool value) { if(value) set(i); else unset(i); }
+        // Same as assign, but safe while other threads write bits of the
+        // same word
+        void assignAtomic(std::size_t i, bool value) {
+            std::uint64_t bit = std::uint64_t(1) << (i & 63);
+            if(value) __atomic_fetch_or(&words[i >> 6], bit, __ATOMIC_RELAXED);
+            else __atomic_fetch_and(&words[i >> 6], ~bit, __ATOMIC_RELAXED);
+        }
+
+        std::size_t count() const;
+        std::size_t getMemoryUsage() const { return words.size()*sizeof(std::uint64_t); }
+
+        std::size_t getWordCount() const { return words.size(); }
+        const std::uint64_t* getWords() const { return words.data(); }
+        std::uint64_t* getWords() { return words.data(); }
+
+    private:
+        std::vector<std::uint64_t, AlignedAllocator<std::uint64_t>> words;
+        std::size_t bits = 0;
+};
+
+#endif //BITSET_HPP
@@ -0,0 +1,155 @@
+#include "BlockerGrid.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAP_MAGIC "BGRD"
+#define MAP_VERSION 1
+// The words start one cache line into the file, so they stay aligned once
+// mapped
+#define MAP_HEADER_SIZE 64
+
+struct MapHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::int32_t size[3];
+};
+
+static std::size_t getWordCount(const vec3i& size) {
+    return (std::size_t(size.x)*size.y*size.z + 63) >> 6;
+}
+
+BlockerGrid::BlockerGrid(const vec3i& size) : size(size) {
+    CORE_ASSERT(size.x > 0 && size.y > 0 && size.z > 0, "BlockerGrid needs a non-empty size");
+    wordCount = ::getWordCount(size);
+    storage.assign(wordCount, 0);
+    words = storage.data();
+    // Every cell is open, so the summary needs no pass over the words
+    bricks = (size + BRICK_SIZE - 1)/BRICK_SIZE;
+    brickBlocked.assign(std::size_t(bricks.x)*bricks.y*bricks.z, 0);
+    brickStates.assign(brickBlocked.size(), EMPTY);
+    bricksBuilt = true;
+}
+
+BlockerGrid::~BlockerGrid() {
+    unmap();
+}
+
+void BlockerGrid::unmap() {
+    if(mapping == nullptr) return;
+    munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+void BlockerGrid::setBlocked(const vec3i& p, bool blocked) {
+    CORE_ASSERT(isInside(p), "Blocker out of bounds");
+    if(isBlocked(p) != blocked) toggle(p);
+}
+
+void BlockerGrid::toggle(const vec3i& p) {
+    CORE_ASSERT(isInside(p), "Blocker out of bounds");
+    std::size_t i = index(p);
+    words[i >> 6] ^= std::uint64_t(1) << (i & 63);
+    if(bricksBuilt) updateBrick(p, isBlocked(p) ? 1 : -1);
+    ++generation;
+}
+
+void BlockerGrid::clear() {
+    std::memset(words, 0, wordCount*sizeof(std::uint64_t));
+    brickBlocked.assign(std::size_t(bricks.x)*bricks.y*bricks.z, 0);
+    brickStates.assign(brickBlocked.size(), EMPTY);
+    bricksBuilt = true;
+    ++generation;
+}
+
+void BlockerGrid::updateBrick(const vec3i& p, int delta) const {
+    std::size_t b = brickIndex(p);
+    brickBlocked[b] += delta;
+    // Bricks on the far borders may be cut short by the volume
+    vec3i lo = p/BRICK_SIZE*BRICK_SIZE;
+    vec3i extent = glm::min(size - lo, vec3i(BRICK_SIZE));
+    int cells = extent.x*extent.y*extent.z;
+    brickStates[b] = brickBlocked[b] == 0 ? EMPTY : brickBlocked[b] == cells ? SOLID : MIXED;
+}
+
+// Counts the blocked cells of every brick, eight bits of a row at a time
+void BlockerGrid::prepareBricks() const {
+    if(bricksBuilt) return;
+    brickBlocked.assign(std::size_t(bricks.x)*bricks.y*bricks.z, 0);
+    brickStates.assign(brickBlocked.size(), EMPTY);
+    for(int z = 0; z < size.z; ++z)
+        for(int y = 0; y < size.y; ++y) {
+            std::size_t row = std::size_t(size.x)*(y + std::size_t(size.y)*z);
+            for(int x = 0; x < size.x; x += BRICK_SIZE) {
+                std::size_t i = row + x;
+                std::size_t w = i >> 6;
+                int offset = int(i & 63);
+                std::uint64_t bits = words[w] >> offset;
+                if(offset > 64 - BRICK_SIZE && w + 1 < wordCount)
+                    bits |= words[w + 1] << (64 - offset);
+                int count = glm::min(BRICK_SIZE, size.x - x);
+                bits &= (std::uint64_t(1) << count) - 1;
+                brickBlocked[brickIndex(vec3i(x, y, z))] += __builtin_popcountll(bits);
+            }
+        }
+    for(int z = 0; z < size.z; z += BRICK_SIZE)
+        for(int y = 0; y < size.y; y += BRICK_SIZE)
+            for(int x = 0; x < size.x; x += BRICK_SIZE)
+                updateBrick(vec3i(x, y, z), 0);
+    bricksBuilt = true;
+}
+
+bool BlockerGrid::save(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if(file == nullptr) return false;
+    char header[MAP_HEADER_SIZE] = {};
+    MapHeader h = {{MAP_MAGIC[0], MAP_MAGIC[1], MAP_MAGIC[2], MAP_MAGIC[3]}, MAP_VERSION, {size.x, size.y, size.z}};
+    std::memcpy(header, &h, sizeof(h));
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              std::fwrite(words, sizeof(std::uint64_t), wordCount, file) == wordCount;
+    return std::fclose(file) == 0 && ok;
+}
+
+bool BlockerGrid::load(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || std::size_t(st.st_size) < MAP_HEADER_SIZE) {
+        close(fd);
+        return false;
+    }
+    std::size_t fileSize = std::size_t(st.st_size);
+    // Private and writable, so the grid can still be edited. Pages are only
+    // copied once they are written to.
+    void* m = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(m == MAP_FAILED) return false;
+    MapHeader h;
+    std::memcpy(&h, m, sizeof(h));
+    vec3i newSize = vec3i(h.size[0], h.size[1], h.size[2]);
+    if(std::memcmp(h.magic, MAP_MAGIC, 4) != 0 || h.version != MAP_VERSION ||
+       newSize.x <= 0 || newSize.y <= 0 || newSize.z <= 0 ||
+       fileSize != MAP_HEADER_SIZE + ::getWordCount(newSize)*sizeof(std::uint64_t)) {
+        munmap(m, fileSize);
+        return false;
+    }
+    unmap();
+    storage = std::vector<std::uint64_t, AlignedAllocator<std::uint64_t>>();
+    mapping = m;
+    mappingSize = fileSize;
+    size = newSize;
+    wordCount = ::getWordCount(size);
+    words = reinterpret_cast<std::uint64_t*>(static_cast<char*>(m) + MAP_HEADER_SIZE);
+    // Counting the bricks would read every page, so it waits for the first
+    // solve that needs them
+    bricks = (size + BRICK_SIZE - 1)/BRICK_SIZE;
+    brickBlocked = std::vector<std::uint16_t>();
+    brickStates = std::vector<unsigned char>();
+    bricksBuilt = false;
+    ++generation;
+    return true;
+}
@@ -0,0 +1,114 @@
+#ifndef BLOCKERGRID_HPP
+#define BLOCKERGRID_HPP
+
+#include "CoreCommons.hpp"
+#include "AlignedAllocator.hpp"
+#include <cstdint>
+#include <string>
+
+// Dense occupancy volume the solvers read blockers from. 2D maps are just
+// volumes with a depth of 1. Cells are stored x-major as one bit each, packed
+// into 64 bit words. The words either live in memory owned by the grid or in
+// a map file mapped by load.
+//
+// On top of the cells, the grid keeps a summary of every brick of 8x8x8
+// cells (8x8 on planar maps) telling whether it is all open, all blocked or
+// a mix. The summary is 512 times smaller than the volume, so it stays in
+// cache while sweeping maps that are mostly rock or mostly air. Loaded maps
+// only get it once prepareBricks is called.
+class BlockerGrid {
+    public:
+        enum BrickState {
+            EMPTY = 0,
+            SOLID,
+            MIXED
+        };
+        static const int BRICK_SHIFT = 3;
+        static const int BRICK_SIZE = 1 << BRICK_SHIFT;
+
+        BlockerGrid(const vec3i& size);
+        ~BlockerGrid();
+
+        BlockerGrid(const BlockerGrid&) = delete;
+        BlockerGrid& operator=(const BlockerGrid&) = delete;
+
+        const vec3i& getSize() const { return size; }
+        bool isInside(const vec3i& p) const {
+            return p.x >= 0 && p.y >= 0 && p.z >= 0 &&
+                   p.x < size.x && p.y < size.y && p.z < size.z;
+        }
+        bool isBlocked(const vec3i& p) const {
+            std::size_t i = index(p);
+            return (words[i >> 6] >> (i & 63)) & 1;
+        }
+        void setBlocked(const vec3i& p, bool blocked);
+        void toggle(const vec3i& p);
+        void clear();
+
+        // Builds the brick summary if the grid doesn't have it yet, with one
+        // pass over the words. Grids made in memory always have it; loaded
+        // ones don't until this is called, so that opening a map stays O(1).
+        // Not thread safe, so it has to be called before the grid is shared
+        // between threads. Once built, edits keep it up to date.
+        void prepareBricks() const;
+        bool hasBricks() const { return bricksBuilt; }
+
+        // State of the brick that holds cell p. Needs the summary.
+        BrickState getBrickState(const vec3i& p) const {
+            CORE_ASSERT(bricksBuilt, "Brick summary wasn't prepared");
+            return BrickState(brickStates[brickIndex(p)]);
+        }
+        // Same as isBlocked, but only reads the cell itself when its brick
+        // is mixed
+        bool isBlockedSparse(const vec3i& p) const {
+            BrickState b = getBrickState(p);
+            return b == SOLID || (b == MIXED && isBlocked(p));
+        }
+        const vec3i& getBrickCount() const { return bricks; }
+
+        // Goes up by one with every edit, so results computed from the grid
+        // can tell whether it changed since
+        std::uint64_t getGeneration() const { return generation; }
+
+        // Map files are a small header followed by the words exactly as they
+        // are kept in memory. Loading maps the file instead of reading or
+        // copying it, and leaves the brick summary for prepareBricks. Later
+        // changes to the grid stay in memory and never reach the file. Both
+        // return false if the file can't be used, in which case the grid is
+        // left untouched.
+        bool save(const std::string& path) const;
+        bool load(const std::string& path);
+
+        std::size_t getWordCount() const { return wordCount; }
+        const std::uint64_t* getWords() const { return words; }
+        std::size_t getMemoryUsage() const {
+            return wordCount*sizeof(std::uint64_t) + brickStates.size()*(sizeof(std::uint16_t) + 1);
+        }
+
+    private:
+        std::size_t index(const vec3i& p) const {
+            return p.x + std::size_t(size.x)*(p.y + std::size_t(size.y)*p.z);
+        }
+        std::size_t brickIndex(const vec3i& p) const {
+            return (p.x >> BRICK_SHIFT) + std::size_t(bricks.x)*((p.y >> BRICK_SHIFT) + std::size_t(bricks.y)*(p.z >> BRICK_SHIFT));
+        }
+        void unmap();
+        void updateBrick(const vec3i& p, int delta) const;
+
+        vec3i size;
+        // Points into storage, or into the mapping when loaded from a file
+        std::uint64_t* words = nullptr;
+        std::size_t wordCount = 0;
+        std::vector<std::uint64_t, AlignedAllocator<std::uint64_t>> storage;
+        void* mapping = nullptr;
+        std::size_t mappingSize = 0;
+        // Blocked cell count and state of every brick. Mutable since they
+        // are built on demand, which doesn't change what the grid holds.
+        vec3i bricks;
+        mutable std::vector<std::uint16_t> brickBlocked;
+        mutable std::vector<unsigned char> brickStates;
+        mutable bool bricksBuilt = false;
+        std::uint64_t generation = 0;
+};
+
+#endif //BLOCKERGRID_HPP
@@ -0,0 +1,82 @@
+#include "ChunkedBlockers.hpp"
+
+bool GridChunkProvider::loadChunk(const vec3i& origin, BlockerGrid& out) {
+    vec3i end = glm::min(origin + out.getSize(), source.getSize());
+    for(int z = origin.z; z < end.z; ++z)
+        for(int y = origin.y; y < end.y; ++y)
+            for(int x = origin.x; x < end.x; ++x)
+                if(source.isBlocked(vec3i(x, y, z)))
+                    out.setBlocked(vec3i(x, y, z) - origin, true);
+    return true;
+}
+
+ChunkedBlockers::ChunkedBlockers(ChunkProvider& provider, const vec3i& size, int chunkShift) :
+    provider(provider), size(size), chunkShift(chunkShift) {
+    CORE_ASSERT(size.x > 0 && size.y > 0 && size.z > 0, "ChunkedBlockers needs a non-empty size");
+    chunkSize = glm::min(vec3i(1 << chunkShift), size);
+    chunkMask = (1 << chunkShift) - 1;
+    chunkCount = (size + (1 << chunkShift) - 1)/(1 << chunkShift);
+    chunks.resize(std::size_t(chunkCount.x)*chunkCount.y*chunkCount.z);
+}
+
+ChunkedBlockers::~ChunkedBlockers() {
+}
+
+// Chunks are visited in order and their distance range checked against the
+// shells, which is cheap next to sweeping the cells of even one of them.
+// Chunks that fall out of range are dropped before any is loaded, so the
+// new ones reuse them and the peak never counts both.
+void ChunkedBlockers::prepareShells(const vec3i& origin, int dMin, int dMax, bool volumetric) {
+    int axes = volumetric ? 3 : 2;
+    for(int pass = 0; pass < 2; ++pass)
+        for(int cz = 0; cz < chunkCount.z; ++cz)
+            for(int cy = 0; cy < chunkCount.y; ++cy)
+                for(int cx = 0; cx < chunkCount.x; ++cx) {
+                    vec3i lo = vec3i(cx, cy, cz)*(1 << chunkShift);
+                    vec3i hi = glm::min(lo + chunkSize, size) - 1;
+                    std::unique_ptr<BlockerGrid>& chunk = chunks[cx + std::size_t(chunkCount.x)*(cy + std::size_t(chunkCount.y)*cz)];
+                    int near = 0;
+                    int far = 0;
+                    for(int a = 0; a < axes; ++a) {
+                        near += glm::max(0, glm::max(lo[a] - origin[a], origin[a] - hi[a]));
+                        far += glm::max(glm::abs(lo[a] - origin[a]), glm::abs(hi[a] - origin[a]));
+                    }
+                    bool inSlice = volumetric || (origin.z >= lo.z && origin.z <= hi.z);
+                    bool needed = inSlice && far >= dMin && near <= dMax;
+                    if(pass == 0) {
+                        if(chunk && !needed) {
+                            spare.push_back(std::move(chunk));
+                            --resident;
+                        }
+                        continue;
+                    }
+                    if(chunk || !needed) continue;
+                    if(spare.empty())
+                        chunk.reset(new BlockerGrid(chunkSize));
+                    else {
+                        chunk = std::move(spare.back());
+                        spare.pop_back();
+                        chunk->clear();
+                    }
+                    provider.loadChunk(lo, *chunk);
+                    ++loads;
+                    ++resident;
+                    peakResident = glm::max(peakResident, resident);
+                }
+}
+
+void ChunkedBlockers::clear() {
+    for(std::unique_ptr<BlockerGrid>& chunk : chunks)
+        chunk.reset();
+    spare.clear();
+    resident = 0;
+}
+
+std::size_t ChunkedBlockers::getMemoryUsage() const {
+    std::size_t bytes = 0;
+    for(const std::unique_ptr<BlockerGrid>& chunk : chunks)
+        if(chunk) bytes += chunk->getMemoryUsage();
+    for(const std::unique_ptr<BlockerGrid>& chunk : spare)
+        bytes += chunk->getMemoryUsage();
+    return bytes;
+}
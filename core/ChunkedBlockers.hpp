@@ -0,0 +1,94 @@
+#ifndef CHUNKEDBLOCKERS_HPP
+#define CHUNKEDBLOCKERS_HPP
+
+#include "BlockerGrid.hpp"
+#include <memory>
+#include <cstdint>
+
+// Source of the blockers of a world too big to keep in memory at once
+class ChunkProvider {
+    public:
+        virtual ~ChunkProvider() {}
+
+        // Fills out, which is empty and has the size of a whole chunk, with
+        // the blockers of the chunk whose first cell is at origin. Cells past
+        // the end of the world are ignored. Returns false if the chunk can't
+        // be read, in which case it is treated as open.
+        virtual bool loadChunk(const vec3i& origin, BlockerGrid& out) = 0;
+};
+
+// Copies chunks out of a BlockerGrid, typically one opened with
+// BlockerGrid::load so that the file is only paged in as chunks are read
+class GridChunkProvider : public ChunkProvider {
+    public:
+        GridChunkProvider(const BlockerGrid& source) : source(source) {}
+
+        bool loadChunk(const vec3i& origin, BlockerGrid& out) override;
+
+    private:
+        const BlockerGrid& source;
+};
+
+// Blocker volume made of cubic chunks that are loaded from a provider when
+// the solver's wavefront reaches them and dropped once it has gone past.
+// Reads the same as a BlockerGrid, but only the chunks prepared for the
+// current shells can be read.
+class ChunkedBlockers {
+    public:
+        // Chunks are 2^chunkShift cells along each axis, or the size of the
+        // world along axes where it is smaller
+        ChunkedBlockers(ChunkProvider& provider, const vec3i& size, int chunkShift = 6);
+        ~ChunkedBlockers();
+
+        const vec3i& getSize() const { return size; }
+        bool isInside(const vec3i& p) const {
+            return p.x >= 0 && p.y >= 0 && p.z >= 0 &&
+                   p.x < size.x && p.y < size.y && p.z < size.z;
+        }
+        bool isBlocked(const vec3i& p) const { return getChunk(p).isBlocked(getLocal(p)); }
+        bool isBlockedSparse(const vec3i& p) const { return getChunk(p).isBlockedSparse(getLocal(p)); }
+
+        // Makes the chunks with cells at manhattan distance [dMin, dMax] from
+        // origin the resident ones, loading those that are missing and
+        // dropping every other one. Planar solves only need the chunks of the
+        // origin's slice. Since the solver's shells only move outwards, each
+        // chunk is loaded at most once per solve.
+        void prepareShells(const vec3i& origin, int dMin, int dMax, bool volumetric);
+        // Drops every chunk
+        void clear();
+
+        const vec3i& getChunkSize() const { return chunkSize; }
+        std::size_t getResidentCount() const { return resident; }
+        std::size_t getPeakResidentCount() const { return peakResident; }
+        std::uint64_t getLoads() const { return loads; }
+        // Bytes used by loaded chunks and the ones kept for reuse
+        std::size_t getMemoryUsage() const;
+
+    private:
+        std::size_t chunkIndex(const vec3i& p) const {
+            vec3i c = vec3i(p.x >> chunkShift, p.y >> chunkShift, p.z >> chunkShift);
+            return c.x + std::size_t(chunkCount.x)*(c.y + std::size_t(chunkCount.y)*c.z);
+        }
+        vec3i getLocal(const vec3i& p) const { return vec3i(p.x & chunkMask, p.y & chunkMask, p.z & chunkMask); }
+        const BlockerGrid& getChunk(const vec3i& p) const {
+            const BlockerGrid* c = chunks[chunkIndex(p)].get();
+            CORE_ASSERT(c != nullptr, "Chunk wasn't prepared");
+            return *c;
+        }
+
+        ChunkProvider& provider;
+        vec3i size;
+        int chunkShift;
+        vec3i chunkSize;
+        int chunkMask;
+        vec3i chunkCount;
+        std::vector<std::unique_ptr<BlockerGrid>> chunks;
+        // Chunks that were dropped, kept to be filled again. With the
+        // resident ones they never add up to more than the peak.
+        std::vector<std::unique_ptr<BlockerGrid>> spare;
+        std::size_t resident = 0;
+        std::size_t peakResident = 0;
+        std::uint64_t loads = 0;
+};
+
+#endif //CHUNKEDBLOCKERS_HPP
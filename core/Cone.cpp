@@ -0,0 +1,170 @@
+#include "Cone.hpp"
+
+#define EPSILON ConePrecision<typename V::value_type>::fineEpsilon()
+
+template<typename V>
+static bool equals(const V& a, const V& b) {
+    return glm::epsilonEqual(a, b, EPSILON) == vec3b(true);
+}
+
+template<typename V>
+BasicAngleDef<typename V::value_type> getCone(const V& p1, const V& p2) {
+    typedef typename V::value_type T;
+    // p1 and p2 are assumed to be unit vectors
+    V dir = glm::normalize(p1+p2);
+    T dist = glm::dot(p1, dir);
+    T tan = glm::distance(p1, dir*dist);
+    return {dir, tan/dist, false};
+}
+
+template<typename V>
+BasicAngleDef<typename V::value_type> getCone(const V& p1, const V& p2, const V& p3) {
+    typedef typename V::value_type T;
+    // The idea is to compute the two planes that run in between p1,p2 and p2,p3.
+    // The direction of the cone will be the intersection of those planes (which
+    // happens to be a line) and the radius can be then computed using
+    // any of the three original vectors.
+    V pn1 = glm::normalize(
+            glm::cross(
+                    glm::normalize(p1+p2),
+                    glm::cross(p1, p2)
+                )
+            );
+    V pn2 = glm::normalize(
+            glm::cross(
+                    glm::normalize(p2+p3),
+                    glm::cross(p2, p3)
+                )
+            );
+    // Cross product of the two plane's normals will give us the new direction
+    V dir = glm::normalize(glm::cross(pn1, pn2));
+    // Flip the direction in case we got it the wrong way.
+    if(glm::dot(dir, p1) <= T(0))
+        dir = -dir;
+    // Compute the new cone angle
+    T dist = glm::dot(p1, dir);
+    T tan = glm::distance(p1, dir*dist);
+    return {dir, tan/dist, false};
+}
+
+template<typename V>
+bool insideCone(const BasicAngleDef<typename V::value_type>& c, const V& v) {
+    typedef typename V::value_type T;
+    T dist = glm::dot(v, c.dir);
+    T tan = glm::distance(v, c.dir*dist);
+    return (dist > T(0) && tan/dist <= (c.halfAngle+EPSILON));
+}
+
+// This is the cheap approximation for the bounding cone problem.
+// Has a bad relative error rate.
+// All vectors in p assumed to be unit vectors
+template<typename V>
+BasicAngleDef<typename V::value_type> getSmallestConeApprox(const V* p, int count) {
+    typedef typename V::value_type T;
+    V dir = V(T(0));
+    for(int i = 0; i < count; ++i)
+        dir += p[i];
+    dir = glm::normalize(dir);
+    T tan = T(0);
+    for(int i = 0; i < count; ++i) {
+        T dist = glm::dot(p[i], dir);
+        tan = glm::max(tan, glm::distance(p[i], dir*dist)/dist);
+    }
+    return {dir, tan, false};
+}
+
+// This is the general implementation for the algorithm found at
+// http://www.cs.technion.ac.il/~cggc/files/gallery-pdfs/Barequet-1.pdf
+// which is an application of the minimum enclosing circle problem to
+// the bounding cone problem. This implementation is just for reference,
+// the actual function to be used is minConeUnroll, the unrolled
+// version of this. All vectors in "points" are assumed to be unit vectors
+template<typename V>
+BasicAngleDef<typename V::value_type> minConeTwoPoint(const std::vector<V>& points, unsigned int last, const V& q1, const V& q2) {
+    typedef BasicAngleDef<typename V::value_type> Cone;
+    Cone c = getCone(q1, q2);
+    for(unsigned int i = 0; i < last; ++i)
+        if(!insideCone(c, points[i]))
+            c = getCone(q1, q2, points[i]);
+    return c;
+}
+template<typename V>
+BasicAngleDef<typename V::value_type> minConeOnePoint(const std::vector<V>& points, unsigned int last, const V& q1) {
+    typedef BasicAngleDef<typename V::value_type> Cone;
+    Cone c = getCone(q1, points[0]);
+    for(unsigned int i = 1; i < last; ++i)
+        if(!insideCone(c, points[i]))
+            c = minConeTwoPoint(points, i, q1, points[i]);
+    return c;
+}
+template<typename V>
+BasicAngleDef<typename V::value_type> minCone(const std::vector<V>& points) {
+    typedef BasicAngleDef<typename V::value_type> Cone;
+    Cone c = getCone(points[0], points[1]);
+    for(unsigned int i = 2; i < points.size(); ++i)
+        if(!insideCone(c, points[i]))
+            c = minConeOnePoint(points, i, points[i]);
+    return c;
+}
+
+// Unrolled version of the aforementioned algorithm.
+// I left the recursive calls commented wherever they would
+// be called for the sake of clarity/readability.
+// This only works with four points, not for the generic case.
+template<typename V>
+BasicAngleDef<typename V::value_type> minConeUnroll(const V& v0, const V& v1, const V& v2, const V& v3) {
+    typedef BasicAngleDef<typename V::value_type> Cone;
+    // c = minCone(p);
+    Cone c = getCone(v0, v1);
+    if(!insideCone(c, v2)) {
+        //c = minConeOnePointUnroll(p, 2, v2);
+        c = getCone(v2, v0);
+        if(!insideCone(c, v1)) {
+            //c = minConeTwoPoint(p, 1, v2, v1);
+            c = getCone(v2, v1);
+            if(!insideCone(c, v0))
+                c = getCone(v2, v1, v0);
+        }
+    }
+    if(!insideCone(c, v3)) {
+        //c = minConeOnePointUnroll(p, 3, v3);
+        c = getCone(v3, v0);
+        if(!insideCone(c, v1)) {
+            //c = minConeTwoPoint(p, 1, v3, v1);
+            c = getCone(v3, v1);
+            if(!insideCone(c, v0))
+                c = getCone(v3, v1, v0);
+        }
+        if(!insideCone(c, v2)) {
+            //c = minConeTwoPoint(p, 2, v3, v2);
+            c = getCone(v3, v2);
+            if(!insideCone(c, v0))
+                c = getCone(v3, v2, v0);
+            if(!insideCone(c, v1))
+                c = getCone(v3, v2, v1);
+        }
+    }
+    return c;
+}
+
+template<typename V>
+BasicAngleDef<typename V::value_type> getSmallestCone(const V (&p)[4], bool approxMode) {
+    for(const V& v : p) {
+        CORE_ASSERT(equals(glm::normalize(v), v), "getSmallestCone expects unit vectors");
+    }
+    if(approxMode)
+        return ApproxConeFit::fit(p);
+    return ExactConeFit::fit(p);
+}
+
+#define INSTANTIATE_CONES(V) \
+    template BasicAngleDef<V::value_type> getCone(const V&, const V&); \
+    template BasicAngleDef<V::value_type> getCone(const V&, const V&, const V&); \
+    template bool insideCone(const BasicAngleDef<V::value_type>&, const V&); \
+    template BasicAngleDef<V::value_type> getSmallestConeApprox(const V*, int); \
+    template BasicAngleDef<V::value_type> minCone(const std::vector<V>&); \
+    template BasicAngleDef<V::value_type> minConeUnroll(const V&, const V&, const V&, const V&); \
+    template BasicAngleDef<V::value_type> getSmallestCone(const V (&)[4], bool);
+
+INSTANTIATE_CONES(vec3f)
+INSTANTIATE_CONES(vec3d)
@@ -0,0 +1,39 @@
+#ifndef CONE_HPP
+#define CONE_HPP
+
+#include "AngleDef.hpp"
+
+// Bounding cone fitting. All input vectors are assumed to be unit vectors.
+// V is vec3f or vec3d, and the cones have the same precision as it; only
+// those two are instantiated, in Cone.cpp.
+template<typename V>
+BasicAngleDef<typename V::value_type> getCone(const V& p1, const V& p2);
+template<typename V>
+BasicAngleDef<typename V::value_type> getCone(const V& p1, const V& p2, const V& p3);
+template<typename V>
+bool insideCone(const BasicAngleDef<typename V::value_type>& c, const V& v);
+
+template<typename V>
+BasicAngleDef<typename V::value_type> getSmallestConeApprox(const V* p, int count);
+template<typename V>
+BasicAngleDef<typename V::value_type> minCone(const std::vector<V>& points);
+template<typename V>
+BasicAngleDef<typename V::value_type> minConeUnroll(const V& v0, const V& v1, const V& v2, const V& v3);
+// Smallest (or approximated) cone around the 4 points in p. Doesn't
+// allocate and only reads p, so it can be called from any thread.
+template<typename V>
+BasicAngleDef<typename V::value_type> getSmallestCone(const V (&p)[4], bool approxMode);
+
+// The two ways getSmallestCone fits a cone, for code that picks one at
+// compile time instead of checking approxMode for every cone
+struct ExactConeFit {
+    template<typename V>
+    static BasicAngleDef<typename V::value_type> fit(const V (&p)[4]) { return minConeUnroll(p[0], p[1], p[2], p[3]); }
+};
+
+struct ApproxConeFit {
+    template<typename V>
+    static BasicAngleDef<typename V::value_type> fit(const V (&p)[4]) { return getSmallestConeApprox(p, 4); }
+};
+
+#endif //CONE_HPP
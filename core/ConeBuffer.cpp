@@ -0,0 +1,63 @@
+#include "ConeBuffer.hpp"
+#include <cstring>
+
+static std::size_t roundUp(std::size_t bytes) {
+    return (bytes + CACHE_LINE - 1) & ~std::size_t(CACHE_LINE - 1);
+}
+
+template<typename T>
+BasicConeBuffer<T>::BasicConeBuffer() {
+}
+
+template<typename T>
+BasicConeBuffer<T>::~BasicConeBuffer() {
+}
+
+template<typename T>
+void BasicConeBuffer<T>::reset(std::size_t count) {
+    this->count = count;
+    if(count > capacity) {
+        capacity = count;
+        // Each array starts on its own cache line
+        std::size_t arrayBytes = roundUp(capacity*sizeof(T));
+        storage.clear();
+        storage.shrink_to_fit();
+        storage.resize(arrayBytes*4 + roundUp(capacity));
+        unsigned char* base = &storage[0];
+        dirX    = reinterpret_cast<T*>(base);
+        dirY    = reinterpret_cast<T*>(base + arrayBytes);
+        dirZ    = reinterpret_cast<T*>(base + arrayBytes*2);
+        tanHalf = reinterpret_cast<T*>(base + arrayBytes*3);
+        flags   = base + arrayBytes*4;
+    }
+    if(count == 0) return;
+    std::memset(dirX, 0, count*sizeof(T));
+    std::memset(dirY, 0, count*sizeof(T));
+    std::memset(dirZ, 0, count*sizeof(T));
+    std::memset(tanHalf, 0, count*sizeof(T));
+    std::memset(flags, 0, count);
+}
+
+template<typename T>
+void BasicConeBuffer<T>::clear(std::size_t begin, std::size_t end) {
+    CORE_ASSERT(begin <= end && end <= count, "Cone range out of bounds");
+    std::size_t n = end - begin;
+    std::memset(dirX + begin, 0, n*sizeof(T));
+    std::memset(dirY + begin, 0, n*sizeof(T));
+    std::memset(dirZ + begin, 0, n*sizeof(T));
+    std::memset(tanHalf + begin, 0, n*sizeof(T));
+    std::memset(flags + begin, 0, n);
+}
+
+template<typename T>
+void BasicConeBuffer<T>::release() {
+    storage.clear();
+    storage.shrink_to_fit();
+    count = 0;
+    capacity = 0;
+    dirX = dirY = dirZ = tanHalf = nullptr;
+    flags = nullptr;
+}
+
+template class BasicConeBuffer<float>;
+template class BasicConeBuffer<double>;
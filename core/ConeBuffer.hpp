@@ -0,0 +1,69 @@
+#ifndef CONEBUFFER_HPP
+#define CONEBUFFER_HPP
+
+#include "AngleDef.hpp"
+#include "AlignedAllocator.hpp"
+
+// Structure-of-arrays storage for one cone per cell. All the arrays live in
+// a single allocation that is kept around between solves and only grows.
+template<typename T>
+class BasicConeBuffer {
+    public:
+        enum Flag {
+            FULL = 0x1,
+            QUEUED = 0x2
+        };
+
+        typedef BasicAngleDef<T> Angle;
+
+        BasicConeBuffer();
+        ~BasicConeBuffer();
+        BasicConeBuffer(const BasicConeBuffer&) = delete;
+        BasicConeBuffer& operator=(const BasicConeBuffer&) = delete;
+
+        // Sets the number of cones and empties all of them
+        void reset(std::size_t count);
+        // Empties the cones in [begin, end) and drops their flags
+        void clear(std::size_t begin, std::size_t end);
+        // Frees the storage, which reset otherwise keeps
+        void release();
+        std::size_t size() const { return count; }
+        std::size_t getCapacity() const { return capacity; }
+
+        Angle get(std::size_t i) const {
+            return {{dirX[i], dirY[i], dirZ[i]}, tanHalf[i], (flags[i] & FULL) != 0};
+        }
+        void set(std::size_t i, const Angle& a) {
+            dirX[i] = a.dir.x;
+            dirY[i] = a.dir.y;
+            dirZ[i] = a.dir.z;
+            tanHalf[i] = a.halfAngle;
+            flags[i] = (flags[i] & ~FULL) | (a.full ? FULL : 0);
+        }
+        bool isEmpty(std::size_t i) const { return tanHalf[i] == T(0) && !(flags[i] & FULL); }
+        bool hasFlag(std::size_t i, Flag f) const { return (flags[i] & f) != 0; }
+        void setFlag(std::size_t i, Flag f) { flags[i] |= f; }
+        void clearFlag(std::size_t i, Flag f) { flags[i] &= ~f; }
+
+        const T* getDirX() const { return dirX; }
+        const T* getDirY() const { return dirY; }
+        const T* getDirZ() const { return dirZ; }
+        const T* getTanHalf() const { return tanHalf; }
+        const unsigned char* getFlags() const { return flags; }
+
+    private:
+        std::vector<unsigned char, AlignedAllocator<unsigned char>> storage;
+        std::size_t count = 0;
+        std::size_t capacity = 0;
+        T* dirX = nullptr;
+        T* dirY = nullptr;
+        T* dirZ = nullptr;
+        T* tanHalf = nullptr;
+        unsigned char* flags = nullptr;
+};
+
+// Only these two are instantiated, in ConeBuffer.cpp
+typedef BasicConeBuffer<float> ConeBuffer;
+typedef BasicConeBuffer<double> ConeBufferDouble;
+
+#endif //CONEBUFFER_HPP
@@ -0,0 +1,545 @@
+#include "ConeSolver.hpp"
+#include "ChunkedBlockers.hpp"
+#include "Cone.hpp"
+
+// Shells with fewer cells than this are swept on the calling thread
+#define PARALLEL_MIN_CELLS 1024
+// Roughly how many cells each parallel work item should hold
+#define PARALLEL_GRAIN_CELLS 128
+// A table of every offset would take as many cones as the volume, so for
+// rolling solves it stops here and farther face cones are computed as they
+// are needed, the same way the table would have
+#define ROLLING_FACE_CONE_EXTENT 64
+
+template<typename T>
+BasicConeSolver<T>::BasicConeSolver() {
+}
+
+template<typename T>
+BasicConeSolver<T>::~BasicConeSolver() {
+}
+
+template<typename T>
+typename BasicConeSolver<T>::Angle BasicConeSolver<T>::getFaceCone(const vec3i& pos, Face f, const vec3i& origin) const {
+    return FaceTable::computeFaceCone(pos - origin, f, genMode2D, approxMode);
+}
+
+// Face cones are shared by every origin, so the table covers any offset
+// within extent
+template<typename T>
+void BasicConeSolver<T>::updateFaceCones(const vec3i& extent) {
+    if(sharedFaceCones != nullptr) {
+        CORE_ASSERT(sharedFaceCones->covers(extent, volumetric ? 3 : 2, genMode2D, approxMode),
+                    "Shared face cones don't match the solve");
+        return;
+    }
+    faceCones.update(extent, volumetric ? 3 : 2, genMode2D, approxMode, pool);
+}
+
+// Cone through face f of prev that the cell beyond it is reached through.
+// The table has full cones for the origin's own faces, which only holds as
+// long as the origin sees everywhere. Narrower views need the real ones,
+// bounded by the corners of the face as seen from the origin's center.
+template<typename T>
+typename BasicConeSolver<T>::Angle BasicConeSolver<T>::getEntryCone(const vec3i& prev, Face f) const {
+    if(view.full || prev != origin) return getFaceCones().get(prev - origin, f);
+    Angle c = {{0.0f, 0.0f, 0.0f}, genMode2D ? T(1) : glm::sqrt(T(2)), false};
+    c.dir[f/2] = (f & 1) ? T(1) : T(-1);
+    return c;
+}
+
+// Stores the cone the same way Angle::set used to: normalized direction,
+// and a zero half angle for full cones. Outputs are written from several
+// workers at once, hence the atomic bit writes.
+template<typename T>
+void BasicConeSolver<T>::setAngle(const vec3i& p, const Angle& def) {
+    Angle c = {{0.0f, 0.0f, 0.0f}, 0.0f, def.full};
+    if(!def.full) {
+        CORE_ASSERT(def.halfAngle >= 0.0f, "Angle must be positive");
+        if(def.halfAngle != 0.0f) c = {glm::normalize(def.dir), def.halfAngle, false};
+    }
+    getBuffer(p).set(getSlot(p), c);
+    std::size_t i = index(p);
+    if(visibleOut != nullptr) visibleOut->assignAtomic(i, c.full || c.halfAngle != 0.0f);
+    if(fractionOut != nullptr) (*fractionOut)[i] = getVisibleFraction(c, p - origin, genMode2D);
+}
+
+// An unoccluded cell's cone is about as wide as the sphere around the cell
+// (the circle around it for 2D face cones), so the cone is measured against
+// that
+template<typename T>
+unsigned char BasicConeSolver<T>::getVisibleFraction(const Angle& cone, const vec3i& offset, bool genMode2D) {
+    if(cone.full) return 255;
+    if(cone.halfAngle == 0.0f) return 0;
+    // The origin's own cell, whatever way it looks
+    if(offset == vec3i(0)) return 255;
+    typedef typename Angle::Vec3 Vec3;
+    T r2 = genMode2D ? T(0.5) : T(0.75);
+    T d2 = glm::dot(Vec3(offset), Vec3(offset));
+    T tanCell = glm::sqrt(r2/(d2 - r2));
+    return (unsigned char)(T(1.5) + glm::min(T(1), cone.halfAngle/tanCell)*T(254));
+}
+
+// The origin's slice unless volumetric, and within maxRange along every
+// axis, which holds for both metrics
+template<typename T>
+typename BasicConeSolver<T>::Region BasicConeSolver<T>::getRegion() const {
+    Region r = {vec3i(0), size - 1};
+    if(!volumetric) r.lo.z = r.hi.z = origin.z;
+    if(maxRange > 0.0f) {
+        int range = int(maxRange);
+        r.lo = glm::max(r.lo, origin - range);
+        r.hi = glm::min(r.hi, origin + range);
+    }
+    return r;
+}
+
+template<typename T>
+template<typename F>
+void BasicConeSolver<T>::forEachRow(const Region& r, F f) const {
+    for(int z = r.lo.z; z <= r.hi.z; ++z)
+        for(int y = r.lo.y; y <= r.hi.y; ++y)
+            f(index(vec3i(r.lo.x, y, z)), index(vec3i(r.hi.x, y, z)) + 1);
+}
+
+template<typename T>
+int BasicConeSolver<T>::getMaxDist() const {
+    int axes = volumetric ? 3 : 2;
+    int d = 0;
+    for(int a = 0; a < axes; ++a)
+        d += glm::max(origin[a], size[a]-1-origin[a]);
+    if(maxRange > 0.0f) {
+        // A manhattan distance is at most sqrt(axes) times the euclidean one
+        float range = rangeMetric == MANHATTAN ? maxRange : maxRange*glm::sqrt(float(axes));
+        d = glm::min(d, int(range) + 1);
+    }
+    return d;
+}
+
+// A cell's cone is the union of what each of its neighbours one step closer
+// to the origin lets through the face they share. Neighbours are always
+// visited in x, y, z order so that every way of reaching a cell (full solve
+// or incremental update) performs the exact same operations.
+template<typename T>
+template<int AXES>
+typename BasicConeSolver<T>::Angle BasicConeSolver<T>::evaluate(const BlockerGrid& blockers, const vec3i& p) const {
+    Angle c = {{0.0f, 0.0f, 0.0f}, 0.0f, false};
+    // This is a blocker, or out of range
+    if(blockers.isBlocked(p) || !isInRange(p)) return c;
+    for(int a = 0; a < AXES; ++a) {
+        if(p[a] == origin[a]) continue;
+        int step = p[a] > origin[a] ? 1 : -1;
+        vec3i prev = p;
+        prev[a] -= step;
+        if(cones.isEmpty(index(prev))) continue;
+        // The face of prev that is shared with p
+        Face f = Face(a*2 + (step > 0 ? 1 : 0));
+        c = Angle::angleUnion(
+                c,
+                Angle::angleIntersection(
+                    getEntryCone(prev, f),
+                    cones.get(index(prev))
+                    )
+                );
+    }
+    if(!view.full) c = Angle::angleIntersection(c, view);
+    return c;
+}
+
+// Only chunked volumes need their blockers brought in before a shell is
+// read
+static void prepareShell(const BlockerGrid&, const vec3i&, int, bool) {
+}
+
+static void prepareShell(ChunkedBlockers& blockers, const vec3i& origin, int d, bool volumetric) {
+    blockers.prepareShells(origin, d, d, volumetric);
+}
+
+// Same as calling evaluate and setAngle for every cell of the batch, but
+// the cone operations go through the AngleBatch kernels one axis at a time.
+// Only the cells that have a visible neighbour along the axis are packed
+// into the kernel's lanes, so occluded areas cost next to nothing.
+template<typename T>
+template<int AXES, typename Blockers>
+void BasicConeSolver<T>::evaluateBatch(const Blockers& blockers, const vec3i* cells, std::size_t n, CellBatch& batch) {
+    std::vector<Angle>& result = batch.result;
+    result.assign(n, {{0.0f, 0.0f, 0.0f}, 0.0f, false});
+    for(int a = 0; a < AXES; ++a) {
+        std::size_t m;
+        {
+            CORE_STATS_TIME(batch.stats, GATHER);
+            batch.lanes.clear();
+            for(std::size_t i = 0; i < n; ++i) {
+                const vec3i& p = cells[i];
+                if(p[a] == origin[a] || blockers.isBlocked(p) || !isInRange(p)) continue;
+                vec3i prev = p;
+                prev[a] -= p[a] > origin[a] ? 1 : -1;
+                if(!getBuffer(prev).isEmpty(getSlot(prev))) batch.lanes.push_back(int(i));
+                else CORE_STATS_COUNT(batch.stats, PRUNED_EMPTY, 1);
+            }
+            m = batch.lanes.size();
+            if(m == 0) continue;
+            batch.faces.reset(m);
+            batch.prev.reset(m);
+            batch.through.reset(m);
+            batch.current.reset(m);
+            for(std::size_t l = 0; l < m; ++l) {
+                const vec3i& p = cells[batch.lanes[l]];
+                int step = p[a] > origin[a] ? 1 : -1;
+                vec3i prev = p;
+                prev[a] -= step;
+                // The face of prev that is shared with p
+                Face f = Face(a*2 + (step > 0 ? 1 : 0));
+                batch.faces.set(l, getEntryCone(prev, f));
+                batch.prev.set(l, getBuffer(prev).get(getSlot(prev)));
+                batch.current.set(l, result[batch.lanes[l]]);
+            }
+        }
+        CORE_STATS_COUNT(batch.stats, CONE_OPS, m);
+        {
+            CORE_STATS_TIME(batch.stats, PROPAGATE);
+            BasicAngleBatch<T>::angleIntersection(batch.faces, batch.prev, batch.through);
+            BasicAngleBatch<T>::angleUnion(batch.current, batch.through, batch.current);
+        }
+        CORE_STATS_TIME(batch.stats, STORE);
+        for(std::size_t l = 0; l < m; ++l)
+            result[batch.lanes[l]] = batch.current.get(l);
+    }
+    CORE_STATS_TIME(batch.stats, STORE);
+    CORE_STATS_COUNT(batch.stats, CELLS_VISITED, n);
+    for(std::size_t i = 0; i < n; ++i)
+        setAngle(cells[i], view.full ? result[i] : Angle::angleIntersection(result[i], view));
+}
+
+// Calls f for every cell inside the volume at manhattan distance d from the
+// origin whose x offset to the origin is dx.
+template<int AXES, typename F>
+void forEachInShellRow(const vec3i& origin, const vec3i& size, int d, int dx, F f) {
+    vec3i lo = -origin;
+    vec3i hi = size - 1 - origin;
+    int rx = d - glm::abs(dx);
+    if(AXES == 2) {
+        if(-rx >= lo.y) f(origin + vec3i(dx, -rx, 0));
+        if(rx != 0 && rx <= hi.y) f(origin + vec3i(dx, rx, 0));
+        return;
+    }
+    for(int dy = glm::max(-rx, lo.y); dy <= glm::min(rx, hi.y); ++dy) {
+        int rz = rx - glm::abs(dy);
+        if(-rz >= lo.z) f(origin + vec3i(dx, dy, -rz));
+        if(rz != 0 && rz <= hi.z) f(origin + vec3i(dx, dy, rz));
+    }
+}
+
+// Every cell of a shell only reads cells of the previous one, so the rows of
+// a shell can be computed in any order, or at the same time. Small shells
+// aren't worth waking the pool up for.
+template<typename T>
+template<int AXES, typename Blockers>
+void BasicConeSolver<T>::sweepShell(const Blockers& blockers, int d) {
+    int dxMin = glm::max(-d, -origin.x);
+    int dxMax = glm::min(d, size.x - 1 - origin.x);
+    int rows = dxMax - dxMin + 1;
+    int rowCells = AXES == 3 ? 2*d + 1 : 2;
+    auto evaluateRows = [&](int begin, int end, CellBatch& batch) {
+        {
+            CORE_STATS_TIME(batch.stats, GATHER);
+            batch.cells.clear();
+            for(int dx = begin; dx < end; ++dx)
+                forEachInShellRow<AXES>(origin, size, d, dx, [&](const vec3i& p) {
+                    batch.cells.push_back(p);
+                });
+        }
+        evaluateBatch<AXES>(blockers, batch.cells.data(), batch.cells.size(), batch);
+    };
+    if(pool == nullptr || rows*rowCells < PARALLEL_MIN_CELLS) {
+        batches.resize(glm::max<std::size_t>(batches.size(), 1));
+        evaluateRows(dxMin, dxMax + 1, batches[0]);
+    }
+    else {
+        batches.resize(glm::max<std::size_t>(batches.size(), pool->getThreadCount()));
+        int grain = glm::max(1, PARALLEL_GRAIN_CELLS/rowCells);
+        pool->parallelFor(rows, grain, [&](int begin, int end, int worker) {
+            evaluateRows(dxMin + begin, dxMin + end, batches[worker]);
+        });
+    }
+    if(!sink) return;
+    for(int dx = dxMin; dx <= dxMax; ++dx)
+        forEachInShellRow<AXES>(origin, size, d, dx, [&](const vec3i& p) {
+            sink(p, getBuffer(p).get(getSlot(p)));
+        });
+}
+
+template<typename T>
+template<int AXES, typename Blockers>
+void BasicConeSolver<T>::evaluateCells(const Blockers& blockers, const vec3i* cells, std::size_t count) {
+    if(pool == nullptr || count < PARALLEL_MIN_CELLS) {
+        batches.resize(glm::max<std::size_t>(batches.size(), 1));
+        evaluateBatch<AXES>(blockers, cells, count, batches[0]);
+        return;
+    }
+    batches.resize(glm::max<std::size_t>(batches.size(), pool->getThreadCount()));
+    pool->parallelFor(int(count), PARALLEL_GRAIN_CELLS, [&](int begin, int end, int worker) {
+        evaluateBatch<AXES>(blockers, cells + begin, std::size_t(end - begin), batches[worker]);
+    });
+}
+
+// The frontier buffers swap roles every shell, so which one ends up biggest
+// depends on the shell count. Growing both to the largest keeps the next
+// solve from allocating again.
+static void matchCapacity(std::vector<vec3i>& a, std::vector<vec3i>& b) {
+    std::size_t capacity = glm::max(a.capacity(), b.capacity());
+    a.reserve(capacity);
+    b.reserve(capacity);
+}
+
+// Sparse version of the shell sweep. Only the open successors of the
+// visible cells of a shell can be visible, so those are the only ones queued
+// for the next shell. A cell belongs to a single shell, so its enqueued bit is
+// never cleared during the solve and every cell is queued at most once.
+// Rolling solves mark queued cells in their shell buffer instead, and empty
+// the slots of a shell once the one after it is done, since cells that are
+// never reached must read as empty.
+template<typename T>
+template<int AXES, typename Blockers>
+void BasicConeSolver<T>::sweepFrontier(Blockers& blockers) {
+    auto markQueued = [&](const vec3i& p) {
+        if(!rollingShells) {
+            if(enqueued.test(index(p))) return false;
+            enqueued.set(index(p));
+            return true;
+        }
+        Buffer& buffer = getBuffer(p);
+        if(buffer.hasFlag(getSlot(p), Buffer::QUEUED)) return false;
+        buffer.setFlag(getSlot(p), Buffer::QUEUED);
+        return true;
+    };
+    if(!rollingShells) {
+        std::size_t count = std::size_t(size.x)*size.y*size.z;
+        if(enqueued.size() == count)
+            forEachRow(enqueuedRegion, [&](std::size_t begin, std::size_t end) { enqueued.clear(begin, end); });
+        else
+            enqueued.reset(count);
+        enqueuedRegion = getRegion();
+    }
+    markQueued(origin);
+    frontier.assign(1, origin);
+    nextFrontier.clear();
+    for(int d = 1; ; ++d) {
+        // nextFrontier still holds the shell before the current one
+        if(rollingShells)
+            for(const vec3i& p : nextFrontier) {
+                getBuffer(p).set(getSlot(p), {{0.0f, 0.0f, 0.0f}, 0.0f, false});
+                getBuffer(p).clearFlag(getSlot(p), Buffer::QUEUED);
+            }
+        nextFrontier.clear();
+        // Queuing already reads the blockers of the next shell
+        prepareShell(blockers, origin, d, volumetric);
+        {
+            CORE_STATS_TIME(stats, GATHER);
+            for(const vec3i& p : frontier) {
+                if(getBuffer(p).isEmpty(getSlot(p))) continue;
+                for(int a = 0; a < AXES; ++a)
+                    for(int step = -1; step <= 1; step += 2) {
+                        if((p[a] - origin[a])*step < 0) continue;
+                        vec3i n = p;
+                        n[a] += step;
+                        // Blockers and cells out of range are already
+                        // empty, so the frontier stops at them. Solid and
+                        // open bricks are settled from the brick summary
+                        // alone.
+                        if(!blockers.isInside(n) || !isInRange(n) || blockers.isBlockedSparse(n)) continue;
+                        if(!markQueued(n)) {
+                            CORE_STATS_COUNT(stats, DUPLICATE_PUSHES, 1);
+                            continue;
+                        }
+                        CORE_STATS_COUNT(stats, QUEUE_PUSHES, 1);
+                        nextFrontier.push_back(n);
+                    }
+            }
+        }
+        if(nextFrontier.empty()) break;
+        std::swap(frontier, nextFrontier);
+        evaluateCells<AXES>(blockers, frontier.data(), frontier.size());
+        if(sink)
+            for(const vec3i& p : frontier)
+                sink(p, getBuffer(p).get(getSlot(p)));
+    }
+    matchCapacity(frontier, nextFrontier);
+}
+
+// Main algorithm! Every cell at manhattan distance d only depends on cells at
+// distance d-1, so cells are swept shell by shell going outwards. This gives
+// the same result whether the shells are swept in parallel or not.
+template<typename T>
+template<int AXES, typename Blockers>
+void BasicConeSolver<T>::sweepShells(Blockers& blockers) {
+    if(sparseFrontier) {
+        sweepFrontier<AXES>(blockers);
+        return;
+    }
+    int maxDist = getMaxDist();
+    for(int d = 1; d <= maxDist; ++d) {
+        prepareShell(blockers, origin, d, volumetric);
+        sweepShell<AXES>(blockers, d);
+    }
+}
+
+template<typename T>
+template<typename Blockers>
+void BasicConeSolver<T>::sweep(Blockers& blockers) {
+    setAngle(origin, view);
+    if(sink) sink(origin, getBuffer(origin).get(getSlot(origin)));
+    if(volumetric)
+        sweepShells<3>(blockers);
+    else
+        sweepShells<2>(blockers);
+    // Workers keep their own stats so they don't have to share counters
+    for(const CellBatch& batch : batches) stats.add(batch.stats);
+}
+
+template<typename T>
+void BasicConeSolver<T>::start(const vec3i& size, const vec3i& origin, const vec3i& faceConeExtent) {
+    // Regions of a different size can't be reused
+    if(size != this->size) {
+        cones.reset(0);
+        enqueued.reset(0);
+    }
+    this->origin = origin;
+    this->size = size;
+    CORE_ASSERT(!(volumetric && genMode2D), "2D face cones can't be propagated through a volume");
+    CORE_ASSERT(viewCone.full || viewCone.halfAngle > 0.0f, "View cone can't be empty");
+    view = viewCone;
+    if(!view.full) view.dir = glm::normalize(view.dir);
+    stats.clear();
+    for(CellBatch& batch : batches) batch.stats.clear();
+    {
+        CORE_STATS_TIME(stats, FACE_CONES);
+        vec3i extent = rollingShells ? glm::min(faceConeExtent, vec3i(ROLLING_FACE_CONE_EXTENT)) : faceConeExtent;
+        updateFaceCones(volumetric ? extent : vec3i(extent.x, extent.y, 1));
+    }
+    CORE_STATS_TIME(stats, RESET);
+    std::size_t count = std::size_t(size.x)*size.y*size.z;
+    if(rollingShells) {
+        cones.release();
+        std::size_t slots = volumetric ? std::size_t(size.x)*size.y*2 : std::size_t(size.x)*2;
+        shells[0].reset(slots);
+        shells[1].reset(slots);
+    }
+    else if(cones.size() == count)
+        forEachRow(conesRegion, [&](std::size_t begin, std::size_t end) { cones.clear(begin, end); });
+    else
+        cones.reset(count);
+    conesRegion = getRegion();
+    if(visibleOut != nullptr) visibleOut->reset(count);
+    if(fractionOut != nullptr) fractionOut->assign(count, 0);
+}
+
+template<typename T>
+void BasicConeSolver<T>::solve(const BlockerGrid& blockers, const vec3i& origin) {
+    CORE_ASSERT(blockers.isInside(origin), "Origin out of bounds");
+    if(sparseFrontier) blockers.prepareBricks();
+    start(blockers.getSize(), origin, blockers.getSize());
+    sweep(blockers);
+}
+
+template<typename T>
+void BasicConeSolver<T>::solve(ChunkedBlockers& blockers, const vec3i& origin) {
+    CORE_ASSERT(blockers.isInside(origin), "Origin out of bounds");
+    CORE_ASSERT(rollingShells, "Chunked solves need rollingShells");
+    start(blockers.getSize(), origin, blockers.getSize());
+    sweep(blockers);
+}
+
+template<typename T>
+std::size_t BasicConeSolver<T>::getMemoryUsage() const {
+    std::size_t coneSize = 4*sizeof(T) + 1;
+    std::size_t bytes = (cones.getCapacity() + shells[0].getCapacity() + shells[1].getCapacity())*coneSize;
+    if(sharedFaceCones == nullptr) bytes += faceCones.getMemoryUsage();
+    bytes += enqueued.getMemoryUsage();
+    bytes += (frontier.capacity() + nextFrontier.capacity())*sizeof(vec3i);
+    for(const CellBatch& batch : batches) {
+        bytes += batch.cells.capacity()*sizeof(vec3i) + batch.result.capacity()*sizeof(Angle) +
+                 batch.lanes.capacity()*sizeof(int);
+        bytes += (batch.faces.size() + batch.prev.size() + batch.through.size() + batch.current.size())*
+                 (4*sizeof(T) + sizeof(int));
+    }
+    return bytes;
+}
+
+template<typename T>
+void BasicConeSolver<T>::getVisible(BitSet& out) const {
+    out.reset(cones.size());
+    for(std::size_t i = 0; i < cones.size(); ++i)
+        if(!cones.isEmpty(i))
+            out.set(i);
+}
+
+// Exact, so that propagation only stops where nothing downstream can change
+// and the result stays the same as solving again
+template<typename T>
+static bool sameCones(const BasicAngleDef<T>& a, const BasicAngleDef<T>& b) {
+    return a.full == b.full && a.halfAngle == b.halfAngle && a.dir == b.dir;
+}
+
+// Only cells whose cones can go through the changed cell need to be
+// recomputed. Starting at the changed cell, a cell is re-evaluated only if
+// one of its predecessors actually changed, so the work stays within the
+// wedge of cells whose visibility was affected.
+template<typename T>
+void BasicConeSolver<T>::updateBlocker(const BlockerGrid& blockers, const vec3i& changed) {
+    CORE_ASSERT(blockers.getSize() == size, "updateBlocker needs the grid that was last solved");
+    CORE_ASSERT(blockers.isInside(changed), "Blocker out of bounds");
+    CORE_ASSERT(!rollingShells, "Rolling solves don't keep the cones updateBlocker needs");
+    CORE_ASSERT(visibleOut == nullptr || visibleOut->size() == cones.size(), "visibleOut wasn't filled by the last solve");
+    CORE_ASSERT(fractionOut == nullptr || fractionOut->size() == cones.size(), "fractionOut wasn't filled by the last solve");
+    stats.clear();
+    CORE_STATS_TIME(stats, INCREMENTAL);
+    // The origin always sees itself, and planar solves ignore other slices
+    if(changed == origin || (!volumetric && changed.z != origin.z)) return;
+    updateFaceCones(volumetric ? size : vec3i(size.x, size.y, 1));
+    if(volumetric)
+        propagateChange<3>(blockers, changed);
+    else
+        propagateChange<2>(blockers, changed);
+}
+
+template<typename T>
+template<int AXES>
+void BasicConeSolver<T>::propagateChange(const BlockerGrid& blockers, const vec3i& changed) {
+    // The frontier buffers are free after a solve and already grown to the
+    // size of a shell, so they serve as the queues here
+    std::vector<vec3i>& current = frontier;
+    std::vector<vec3i>& next = nextFrontier;
+    current.assign(1, changed);
+    CORE_STATS_COUNT(stats, QUEUE_PUSHES, 1);
+    while(!current.empty()) {
+        next.clear();
+        for(const vec3i& p : current) {
+            cones.clearFlag(index(p), Buffer::QUEUED);
+            CORE_STATS_COUNT(stats, CELLS_VISITED, 1);
+            Angle old = cones.get(index(p));
+            setAngle(p, evaluate<AXES>(blockers, p));
+            if(sameCones(old, cones.get(index(p)))) continue;
+            // Queue the successors, which are one step further from the origin
+            for(int a = 0; a < AXES; ++a)
+                for(int step = -1; step <= 1; step += 2) {
+                    if((p[a] - origin[a])*step < 0) continue;
+                    vec3i n = p;
+                    n[a] += step;
+                    if(!blockers.isInside(n)) continue;
+                    if(cones.hasFlag(index(n), Buffer::QUEUED)) {
+                        CORE_STATS_COUNT(stats, DUPLICATE_PUSHES, 1);
+                        continue;
+                    }
+                    cones.setFlag(index(n), Buffer::QUEUED);
+                    CORE_STATS_COUNT(stats, QUEUE_PUSHES, 1);
+                    next.push_back(n);
+                }
+        }
+        std::swap(current, next);
+    }
+    matchCapacity(current, next);
+}
+
+template class BasicConeSolver<float>;
+template class BasicConeSolver<double>;
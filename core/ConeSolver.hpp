@@ -0,0 +1,240 @@
+#ifndef CONESOLVER_HPP
+#define CONESOLVER_HPP
+
+#include "BlockerGrid.hpp"
+#include "ConeBuffer.hpp"
+#include "AngleBatch.hpp"
+#include "FaceConeTable.hpp"
+#include "BitSet.hpp"
+#include "ThreadPool.hpp"
+#include "SolverStats.hpp"
+#include <functional>
+
+class ChunkedBlockers;
+
+// Cone propagation from a single origin through a blocker volume. Every cell
+// ends up with the cone of directions from the origin that reach it. T is
+// the precision of the cones, see ConePrecision.
+template<typename T>
+class BasicConeSolver {
+    public:
+        enum Face {
+            MINX = 0,
+            MAXX,
+            MINY,
+            MAXY,
+            MINZ,
+            MAXZ,
+        };
+        enum RangeMetric {
+            MANHATTAN = 0,
+            EUCLIDEAN
+        };
+
+        typedef BasicAngleDef<T> Angle;
+        typedef BasicConeBuffer<T> Buffer;
+        typedef BasicFaceConeTable<T> FaceTable;
+        // Receives every cell of a shell once the whole shell is finished,
+        // on the thread that called solve
+        typedef std::function<void(const vec3i& p, const Angle& cone)> ConeSink;
+
+        BasicConeSolver();
+        ~BasicConeSolver();
+
+        // Unless volumetric is set, propagation stays within the origin's
+        // z slice
+        void solve(const BlockerGrid& blockers, const vec3i& origin);
+        // Same, for volumes whose blockers are streamed in chunks. Needs
+        // rollingShells, so the memory used is the two shells plus the chunks
+        // under them, whatever the size of the volume. The outputs above
+        // are still dense, so results are best taken from sink.
+        void solve(ChunkedBlockers& blockers, const vec3i& origin);
+        // Brings the last solution up to date after the blocker at changed
+        // has been toggled in blockers. Gives the same cones as solving
+        // again, bit for bit.
+        void updateBlocker(const BlockerGrid& blockers, const vec3i& changed);
+
+        const vec3i& getSize() const { return size; }
+        const vec3i& getOrigin() const { return origin; }
+        Angle getAngle(const vec3i& p) const { return cones.get(index(p)); }
+        bool isVisible(const vec3i& p) const { return !cones.isEmpty(index(p)); }
+        const Buffer& getCones() const { return cones; }
+        // Packs the visible cells of the last solution into out
+        void getVisible(BitSet& out) const;
+        // Bytes held by the cone buffers, the face cone table unless it is
+        // shared, and the per-shell lists, which is what solving needs
+        // besides the blockers and the outputs
+        std::size_t getMemoryUsage() const;
+
+        // How much of the cell at offset from the origin the cone covers, from
+        // 1 (a sliver) to 255 (all of it, or a full cone). 0 if empty.
+        static unsigned char getVisibleFraction(const Angle& cone, const vec3i& offset, bool genMode2D);
+
+        // Cone of the directions from origin that go through face f of pos
+        Angle getFaceCone(const vec3i& pos, Face f, const vec3i& origin) const;
+        // Face cones used by the last solve, kept around for later ones
+        const FaceTable& getFaceCones() const { return sharedFaceCones ? *sharedFaceCones : faceCones; }
+        // Timers and counters of the last solve or updateBlocker. All zero
+        // unless core is built with CORE_STATS.
+        const SolverStats& getStats() const { return stats; }
+
+        // If genMode2D is true, face cones are built from two points per face
+        // instead of 4, hence simulating a 2D grid case
+        bool genMode2D = false;
+        bool approxMode = false;
+        // If volumetric is true, cones are propagated through every slice of
+        // the volume instead of just the origin's one. Needs 3D face cones.
+        bool volumetric = false;
+        // If set, each shell only visits the cells next to a visible cell of
+        // the previous one instead of all of its cells. Same result, but
+        // faster when most of the volume ends up occluded. Builds the brick
+        // summary of loaded grids on the first solve.
+        bool sparseFrontier = false;
+        // If positive, cells farther than maxRange from the origin, measured
+        // with rangeMetric, are never reached. The sweep stops at the last
+        // shell with cells in range, so the cost follows the range and not
+        // the size of the volume.
+        float maxRange = 0.0f;
+        RangeMetric rangeMetric = EUCLIDEAN;
+        // Directions the origin looks in. Unless it is full, it replaces the
+        // full cone the origin starts with, and every cone is clipped to it
+        // as it is propagated, so only cells it reaches are visible.
+        // halfAngle is a tangent like everywhere else, so views wider than
+        // 180 degrees have to stay full. With sparseFrontier the cells
+        // outside of the view are never visited.
+        Angle viewCone = {{0.0f, 0.0f, 0.0f}, 0.0f, true};
+        // If set, each shell of cells at the same manhattan distance from the
+        // origin is computed in parallel on this pool. Not owned.
+        ThreadPool* pool = nullptr;
+        // If set, face cones are read from this table instead of one owned by
+        // the solver. It must already cover the volume and settings that are
+        // solved. Not owned.
+        const FaceTable* sharedFaceCones = nullptr;
+        // Optional outputs for callers that don't need the cones themselves,
+        // indexed like the blocker grid. They are written as soon as each cell
+        // is finished and kept up to date by updateBlocker. visibleOut gets a
+        // bit per visible cell and fractionOut the getVisibleFraction of
+        // every cell. Not owned.
+        BitSet* visibleOut = nullptr;
+        std::vector<unsigned char>* fractionOut = nullptr;
+        // If set, gets the cells of every shell in order as they are
+        // finished, starting with the origin. Cells never reached by a
+        // sparseFrontier solve are empty and aren't passed.
+        ConeSink sink;
+        // If set, cones are only kept for the last two shells instead of the
+        // whole volume, and the face cone table only covers offsets up to a
+        // fixed extent, so an N^3 volume takes O(N^2) cones instead of
+        // O(N^3). The table only grows, so this doesn't hold for a solver
+        // that did a full solve of a bigger volume before, or with
+        // sharedFaceCones. Results must then be taken from sink or the
+        // outputs above: getAngle, isVisible, getCones, getVisible and
+        // updateBlocker don't work after such a solve.
+        bool rollingShells = false;
+
+    private:
+        // Per-thread buffers for evaluating a list of cells at once
+        struct CellBatch {
+            std::vector<vec3i> cells;
+            std::vector<Angle> result;
+            // Cells that go through the kernels for the current axis
+            std::vector<int> lanes;
+            BasicAngleBatch<T> faces;
+            BasicAngleBatch<T> prev;
+            BasicAngleBatch<T> through;
+            BasicAngleBatch<T> current;
+            SolverStats stats;
+        };
+
+        // Box of cells a solve can write to
+        struct Region {
+            vec3i lo;
+            vec3i hi;
+        };
+
+        std::size_t index(const vec3i& p) const {
+            return p.x + std::size_t(size.x)*(p.y + std::size_t(size.y)*p.z);
+        }
+        // Where the cone of p is kept: the whole volume, or for rolling
+        // solves the buffer of p's shell. A shell holds at most one cell per
+        // (x, y) on each side of the origin along z (per x on each side along
+        // y when planar).
+        const Buffer& getBuffer(const vec3i& p) const {
+            if(!rollingShells) return cones;
+            vec3i d = glm::abs(p - origin);
+            return shells[(d.x + d.y + d.z) & 1];
+        }
+        Buffer& getBuffer(const vec3i& p) {
+            return const_cast<Buffer&>(static_cast<const BasicConeSolver*>(this)->getBuffer(p));
+        }
+        std::size_t getSlot(const vec3i& p) const {
+            if(!rollingShells) return index(p);
+            if(volumetric) return p.x + std::size_t(size.x)*(p.y + std::size_t(size.y)*(p.z < origin.z ? 1 : 0));
+            return p.x + std::size_t(size.x)*(p.y < origin.y ? 1 : 0);
+        }
+        bool isInRange(const vec3i& p) const {
+            if(maxRange <= 0.0f) return true;
+            vec3i d = p - origin;
+            if(rangeMetric == MANHATTAN) return float(glm::abs(d.x) + glm::abs(d.y) + glm::abs(d.z)) <= maxRange;
+            return float(d.x*d.x + d.y*d.y + d.z*d.z) <= maxRange*maxRange;
+        }
+        Angle getEntryCone(const vec3i& prev, Face f) const;
+        Region getRegion() const;
+        // Calls f(begin, end) with the index range of every row of r
+        template<typename F>
+        void forEachRow(const Region& r, F f) const;
+        void setAngle(const vec3i& p, const Angle& def);
+        template<int AXES>
+        Angle evaluate(const BlockerGrid& blockers, const vec3i& p) const;
+        int getMaxDist() const;
+        void updateFaceCones(const vec3i& extent);
+        void start(const vec3i& size, const vec3i& origin, const vec3i& faceConeExtent);
+        // The sweep reads blockers from either a BlockerGrid or a
+        // ChunkedBlockers. Everything that propagates cones is compiled once
+        // for planar (2 axes) and once for volumetric (3 axes) solves, so the
+        // loops over neighbours are unrolled and don't check volumetric for
+        // every cell. sweep and updateBlocker pick one once per call. Only
+        // instantiated in ConeSolver.cpp, like the class itself.
+        template<int AXES, typename Blockers>
+        void evaluateBatch(const Blockers& blockers, const vec3i* cells, std::size_t count, CellBatch& batch);
+        template<int AXES, typename Blockers>
+        void evaluateCells(const Blockers& blockers, const vec3i* cells, std::size_t count);
+        template<int AXES, typename Blockers>
+        void sweepShell(const Blockers& blockers, int d);
+        template<int AXES, typename Blockers>
+        void sweepFrontier(Blockers& blockers);
+        template<int AXES, typename Blockers>
+        void sweepShells(Blockers& blockers);
+        template<typename Blockers>
+        void sweep(Blockers& blockers);
+        template<int AXES>
+        void propagateChange(const BlockerGrid& blockers, const vec3i& changed);
+
+        Buffer cones;
+        // Even and odd shells of rolling solves
+        Buffer shells[2];
+        FaceTable faceCones;
+        std::vector<CellBatch> batches;
+        // Cells of the current and next shell for sparseFrontier solves, and
+        // the queues of updateBlocker
+        std::vector<vec3i> frontier;
+        std::vector<vec3i> nextFrontier;
+        BitSet enqueued;
+        // What the last solves wrote to cones and enqueued, the only cells
+        // that have to be emptied before the next one. Range limited solves
+        // in a big volume then don't pay for the whole of it.
+        Region conesRegion;
+        Region enqueuedRegion;
+        SolverStats stats;
+        // viewCone as of the last solve, normalized
+        Angle view = {{0.0f, 0.0f, 0.0f}, 0.0f, true};
+        vec3i size = vec3i(0);
+        vec3i origin = vec3i(0);
+};
+
+// Float is the fast default. Double loses fewer of the thin cones that
+// reach far cells through narrow gaps, for maps where those matter. Only
+// these two are instantiated, in ConeSolver.cpp.
+typedef BasicConeSolver<float> ConeSolver;
+typedef BasicConeSolver<double> ConeSolverDouble;
+
+#endif //CONESOLVER_HPP
@@ -0,0 +1,30 @@
+#ifndef CORECOMMONS_HPP
+#define CORECOMMONS_HPP
+
+// Everything in core/ must stay free of GL, SDL and the scenegraph so it can
+// be linked into headless tools. Only glm (through VBE's math header) is used.
+#include <VBE/math.hpp>
+#include <VBE/dependencies/glm/gtc/epsilon.hpp>
+#include <VBE/dependencies/glm/gtx/norm.hpp>
+#include <VBE/dependencies/glm/gtx/hash.hpp>
+#include <vector>
+#include <algorithm>
+#include <queue>
+#include <limits>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef NDEBUG
+    // The expression is still seen by the compiler, but never evaluated, so
+    // variables only used by asserts don't warn in release builds
+    #define CORE_ASSERT(expr, msg) ((void)sizeof(expr))
+#else
+    #define CORE_ASSERT(expr, msg) do { \
+        if(!(expr)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " << msg << std::endl; \
+            std::abort(); \
+        } \
+    } while(0)
+#endif
+
+#endif //CORECOMMONS_HPP
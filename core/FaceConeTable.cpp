@@ -0,0 +1,180 @@
+#include "FaceConeTable.hpp"
+#include "Cone.hpp"
+#include <cstdint>
+
+vec3i diff[6] = {
+    {-1, 0, 0},
+    { 1, 0, 0},
+    { 0,-1, 0},
+    { 0, 1, 0},
+    { 0, 0,-1},
+    { 0, 0, 1}
+};
+
+// Offsets per work item when filling the table in parallel
+#define PARALLEL_GRAIN 4096
+
+template<typename T>
+BasicFaceConeTable<T>::BasicFaceConeTable() {
+}
+
+template<typename T>
+BasicFaceConeTable<T>::~BasicFaceConeTable() {
+}
+
+// Small xorshift generator for shuffling face corners. It is seeded from
+// the face being computed instead of sharing rand()'s global state, so a
+// face always gets the same shuffle, whichever thread computes it and
+// whenever it does.
+class FaceRandom {
+    public:
+        FaceRandom(const vec3i& offset, int face) {
+            state = 2166136261u;
+            int values[4] = {offset.x, offset.y, offset.z, face};
+            for(int v : values)
+                state = (state ^ std::uint32_t(v))*16777619u;
+            if(state == 0) state = 1;
+        }
+
+        // Uniform-ish number in [0, bound)
+        int next(int bound) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return int(state%std::uint32_t(bound));
+        }
+
+    private:
+        std::uint32_t state;
+};
+
+// This is a standard Fisher-Yates random in-place shuffle
+template<typename E, int N>
+void fy_shuffle(E (&v)[N], FaceRandom& random) {
+    for(int i = N-1; i > 0; --i) {
+        int j = random.next(i+1);
+        std::swap(v[i], v[j]);
+    }
+}
+
+// The geometry for one combination of settings, fixed at compile time so
+// that filling a table doesn't check them again for every face. 2D face
+// cones go through two points, so they have no use for Fit.
+template<typename T, bool GEN_2D, typename Fit>
+static BasicAngleDef<T> computeFaceConeFor(const vec3i& offset, int face) {
+    typedef typename ConePrecision<T>::Vec2 Vec2;
+    typedef typename ConePrecision<T>::Vec3 Vec3;
+    if(offset == vec3i(0))
+        return {{0.0f, 0.0f, 0.0f}, 0.0f, true};
+    Vec3 center = Vec3(offset)+Vec3(diff[face])*T(0.5);
+    int axis = face/2;
+    if(!GEN_2D) {
+        Vec3 p[4];
+        switch(axis) {
+            case 0:
+                p[0] = center+Vec3( 0.0f, 0.5f, 0.5f);
+                p[1] = center+Vec3( 0.0f,-0.5f, 0.5f);
+                p[2] = center+Vec3( 0.0f, 0.5f,-0.5f);
+                p[3] = center+Vec3( 0.0f,-0.5f,-0.5f);
+                break;
+            case 1:
+                p[0] = center+Vec3( 0.5f, 0.0f, 0.5f);
+                p[1] = center+Vec3(-0.5f, 0.0f, 0.5f);
+                p[2] = center+Vec3( 0.5f, 0.0f,-0.5f);
+                p[3] = center+Vec3(-0.5f, 0.0f,-0.5f);
+                break;
+            case 2:
+                p[0] = center+Vec3( 0.5f, 0.5f, 0.0f);
+                p[1] = center+Vec3(-0.5f, 0.5f, 0.0f);
+                p[2] = center+Vec3( 0.5f,-0.5f, 0.0f);
+                p[3] = center+Vec3(-0.5f,-0.5f, 0.0f);
+                break;
+        }
+        for(Vec3& v : p) v = glm::normalize(v);
+        FaceRandom random(offset, face);
+        fy_shuffle(p, random);
+        return Fit::fit(p);
+    }
+    Vec2 p1, p2;
+    switch(axis) {
+        case 1:
+            p1 = Vec2(center)+Vec2( 0.5f, 0.0f);
+            p2 = Vec2(center)+Vec2(-0.5f, 0.0f);
+            break;
+        case 0:
+            p1 = Vec2(center)+Vec2( 0.0f,  0.5f);
+            p2 = Vec2(center)+Vec2( 0.0f, -0.5f);
+            break;
+        default:
+            CORE_ASSERT(axis != 2, "3rd dimension disallowed in 2D mode");
+    }
+    return getCone(glm::normalize(Vec3(p1, 0.0f)), glm::normalize(Vec3(p2, 0.0f)));
+}
+
+template<typename T, bool GEN_2D, typename Fit>
+static void fillFaceCones(BasicConeBuffer<T>& cones, const vec3i& extent, std::size_t begin, std::size_t end) {
+    std::size_t perAxis = std::size_t(extent.x)*extent.y*extent.z;
+    for(std::size_t i = begin; i < end; ++i) {
+        int axis = int(i/perAxis);
+        std::size_t j = i%perAxis;
+        vec3i offset(int(j%extent.x), int(j/extent.x%extent.y), int(j/extent.x/extent.y));
+        cones.set(i, computeFaceConeFor<T, GEN_2D, Fit>(offset, axis*2 + 1));
+    }
+}
+
+template<typename T>
+typename BasicFaceConeTable<T>::Angle BasicFaceConeTable<T>::computeFaceCone(const vec3i& offset, int face, bool genMode2D, bool approxMode) {
+    if(genMode2D) return computeFaceConeFor<T, true, ExactConeFit>(offset, face);
+    if(approxMode) return computeFaceConeFor<T, false, ApproxConeFit>(offset, face);
+    return computeFaceConeFor<T, false, ExactConeFit>(offset, face);
+}
+
+template<typename T>
+bool BasicFaceConeTable<T>::covers(const vec3i& extent, int axes, bool genMode2D, bool approxMode) const {
+    return genMode2D == this->genMode2D && approxMode == this->approxMode && axes <= this->axes &&
+           extent.x <= this->extent.x && extent.y <= this->extent.y && extent.z <= this->extent.z;
+}
+
+template<typename T>
+void BasicFaceConeTable<T>::update(const vec3i& extent, int axes, bool genMode2D, bool approxMode, ThreadPool* pool) {
+    if(covers(extent, axes, genMode2D, approxMode))
+        return;
+    if(genMode2D != this->genMode2D || approxMode != this->approxMode) {
+        this->extent = extent;
+        this->axes = axes;
+    }
+    else {
+        this->extent = glm::max(extent, this->extent);
+        this->axes = glm::max(axes, this->axes);
+    }
+    this->genMode2D = genMode2D;
+    this->approxMode = approxMode;
+    std::size_t perAxis = std::size_t(this->extent.x)*this->extent.y*this->extent.z;
+    cones.reset(perAxis*this->axes);
+    // Every offset is stored with its face on the positive side. The
+    // settings are picked once for the whole table.
+    void (*fillRange)(BasicConeBuffer<T>&, const vec3i&, std::size_t, std::size_t) =
+        genMode2D ? fillFaceCones<T, true, ExactConeFit> :
+        approxMode ? fillFaceCones<T, false, ApproxConeFit> :
+        fillFaceCones<T, false, ExactConeFit>;
+    auto fill = [&](std::size_t begin, std::size_t end) {
+        fillRange(cones, this->extent, begin, end);
+    };
+    if(pool == nullptr) {
+        fill(0, cones.size());
+        return;
+    }
+    int items = int((cones.size() + PARALLEL_GRAIN - 1)/PARALLEL_GRAIN);
+    pool->parallelFor(items, 1, [&](int begin, int end, int worker) {
+        (void) worker;
+        fill(std::size_t(begin)*PARALLEL_GRAIN, glm::min(std::size_t(end)*PARALLEL_GRAIN, cones.size()));
+    });
+}
+
+template<typename T>
+std::size_t BasicFaceConeTable<T>::getMemoryUsage() const {
+    return cones.getCapacity()*(4*sizeof(T) + 1);
+}
+
+template class BasicFaceConeTable<float>;
+template class BasicFaceConeTable<double>;
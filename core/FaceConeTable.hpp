@@ -0,0 +1,65 @@
+#ifndef FACECONETABLE_HPP
+#define FACECONETABLE_HPP
+
+#include "ConeBuffer.hpp"
+#include "ThreadPool.hpp"
+
+// Face cones only depend on the offset from the origin to the cell and on
+// the face, and mirroring the offset along an axis just mirrors the cone. So
+// they are computed once for the offsets with no negative component and
+// looked up from then on, for any origin. Faces are numbered like
+// ConeSolver::Face (axis*2, +1 for the face on the positive side).
+template<typename T>
+class BasicFaceConeTable {
+    public:
+        typedef BasicAngleDef<T> Angle;
+
+        BasicFaceConeTable();
+        ~BasicFaceConeTable();
+
+        // Makes sure every offset whose absolute value is below extent along
+        // each axis is in the table, for the faces of axes [0, axes). The
+        // table is rebuilt if the face cone settings change, and otherwise
+        // only grows.
+        void update(const vec3i& extent, int axes, bool genMode2D, bool approxMode, ThreadPool* pool = nullptr);
+        bool covers(const vec3i& extent, int axes, bool genMode2D, bool approxMode) const;
+
+        // Cone of directions from the origin that go through face f of the
+        // cell at offset. Only faces that look away from the origin are
+        // stored, which are the only ones cones propagate through. Offsets
+        // the table doesn't cover are computed on the spot, the same way the
+        // table would have.
+        Angle get(const vec3i& offset, int face) const {
+            int axis = face/2;
+            bool positive = (face & 1) != 0;
+            CORE_ASSERT(positive ? offset[axis] >= 0 : offset[axis] <= 0, "Face looks towards the origin");
+            vec3i a = glm::abs(offset);
+            Angle c = a.x < extent.x && a.y < extent.y && a.z < extent.z && axis < axes ?
+                cones.get(a.x + std::size_t(extent.x)*(a.y + std::size_t(extent.y)*(a.z + std::size_t(extent.z)*axis))) :
+                computeFaceCone(a, axis*2 + 1, genMode2D, approxMode);
+            if(offset.x < 0 || (axis == 0 && !positive)) c.dir.x = -c.dir.x;
+            if(offset.y < 0 || (axis == 1 && !positive)) c.dir.y = -c.dir.y;
+            if(offset.z < 0 || (axis == 2 && !positive)) c.dir.z = -c.dir.z;
+            return c;
+        }
+
+        const vec3i& getExtent() const { return extent; }
+        std::size_t size() const { return cones.size(); }
+        std::size_t getMemoryUsage() const;
+
+        // The actual geometry, used to fill the table
+        static Angle computeFaceCone(const vec3i& offset, int face, bool genMode2D, bool approxMode);
+
+    private:
+        BasicConeBuffer<T> cones;
+        vec3i extent = vec3i(0);
+        int axes = 0;
+        bool genMode2D = false;
+        bool approxMode = false;
+};
+
+// Only these two are instantiated, in FaceConeTable.cpp
+typedef BasicFaceConeTable<float> FaceConeTable;
+typedef BasicFaceConeTable<double> FaceConeTableDouble;
+
+#endif //FACECONETABLE_HPP
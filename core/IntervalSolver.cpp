@@ -0,0 +1,177 @@
+#include "IntervalSolver.hpp"
+#include "Cone.hpp"
+
+typedef IntervalSolver::Interval Interval;
+
+static const Interval EMPTY_INTERVAL = {vec2i(0), vec2i(0), Interval::EMPTY};
+static const Interval FULL_INTERVAL = {vec2i(0), vec2i(0), Interval::FULL};
+
+// Positive if b is counterclockwise from a. Corners are at most twice the
+// size of the slice away, so the products fit easily.
+static std::int64_t cross(const vec2i& a, const vec2i& b) {
+    return std::int64_t(a.x)*b.y - std::int64_t(a.y)*b.x;
+}
+
+// Which edge wins depends on the map, so it is picked per component, which
+// compiles to conditional moves instead of branches that often mispredict
+static vec2i select(bool first, const vec2i& a, const vec2i& b) {
+    return vec2i(first ? a.x : b.x, first ? a.y : b.y);
+}
+
+// Face of the cell at offset (dx, dy) that leads to (dx + 1, dy), or to
+// (dx, dy + 1) if alongY. The origin's faces see everything, like its face
+// cones do.
+static Interval getFaceInterval(int dx, int dy, bool alongY) {
+    if(dx == 0 && dy == 0) return FULL_INTERVAL;
+    if(alongY) return {vec2i(2*dx + 1, 2*dy + 1), vec2i(2*dx - 1, 2*dy + 1), Interval::PARTIAL};
+    return {vec2i(2*dx + 1, 2*dy - 1), vec2i(2*dx + 1, 2*dy + 1), Interval::PARTIAL};
+}
+
+// As with angleIntersection, intervals that only touch have nothing in
+// common
+static Interval intersect(const Interval& a, const Interval& b) {
+    if(a.state == Interval::EMPTY || b.state == Interval::FULL) return a;
+    if(b.state == Interval::EMPTY || a.state == Interval::FULL) return b;
+    Interval c = {
+        select(cross(a.lo, b.lo) > 0, b.lo, a.lo),
+        select(cross(a.hi, b.hi) > 0, a.hi, b.hi),
+        Interval::PARTIAL
+    };
+    if(cross(c.lo, c.hi) <= 0) return EMPTY_INTERVAL;
+    return c;
+}
+
+// Intervals that don't overlap get the gap between them too, like with
+// angleUnion
+static Interval unite(const Interval& a, const Interval& b) {
+    if(a.state == Interval::EMPTY || b.state == Interval::FULL) return b;
+    if(b.state == Interval::EMPTY || a.state == Interval::FULL) return a;
+    return {
+        select(cross(a.lo, b.lo) > 0, a.lo, b.lo),
+        select(cross(a.hi, b.hi) > 0, b.hi, a.hi),
+        Interval::PARTIAL
+    };
+}
+
+IntervalSolver::IntervalSolver() {
+}
+
+IntervalSolver::~IntervalSolver() {
+}
+
+bool IntervalSolver::isInRange(int dx, int dy) const {
+    if(maxRange <= 0.0f) return true;
+    if(rangeMetric == ConeSolver::MANHATTAN) return float(dx + dy) <= maxRange;
+    return float(dx*dx + dy*dy) <= maxRange*maxRange;
+}
+
+AngleDef IntervalSolver::toCone(const Interval& c, int sx, int sy) {
+    if(c.state != Interval::PARTIAL) return {{0.0f, 0.0f, 0.0f}, 0.0f, c.state == Interval::FULL};
+    vec3f lo = glm::normalize(vec3f(float(sx*c.lo.x), float(sy*c.lo.y), 0.0f));
+    vec3f hi = glm::normalize(vec3f(float(sx*c.hi.x), float(sy*c.hi.y), 0.0f));
+    return getCone(lo, hi);
+}
+
+void IntervalSolver::setOutputs(int x, int y, int sx, int sy, const Interval& c) {
+    std::size_t i = x + std::size_t(size.x)*(y + std::size_t(size.y)*origin.z);
+    if(visibleOut != nullptr) visibleOut->assign(i, c.state != Interval::EMPTY);
+    if(fractionOut != nullptr)
+        (*fractionOut)[i] = ConeSolver::getVisibleFraction(toCone(c, sx, sy), vec3i(x, y, origin.z) - origin, true);
+}
+
+// Row by row away from the origin. A cell is only reached from the one
+// before it in its row and the one before it in the previous row, so each
+// row only has to start at the first visible cell of the previous one, and
+// ends once neither of those is visible anymore. The sweep stops at the
+// first row with nothing visible, so occluded areas cost nothing. Cells on
+// the origin's row and column belong to two quadrants, and get the same
+// interval from both.
+void IntervalSolver::sweepQuadrant(const BlockerGrid& blockers, int sx, int sy) {
+    std::vector<vec2i>& rows = spans[sx > 0 ? 1 : 0];
+    vec2i extent = vec2i(sx > 0 ? size.x - origin.x : origin.x + 1,
+                         sy > 0 ? size.y - origin.y : origin.y + 1);
+    vec2i prev = vec2i(0, -1);
+    for(int dy = 0; dy < extent.y; ++dy) {
+        int y = origin.y + sy*dy;
+        vec2i span = vec2i(0, -1);
+        Interval left = EMPTY_INTERVAL;
+        int begin = prev.x;
+        if(dy == 0) {
+            cells[index(origin.x, y)] = FULL_INTERVAL;
+            setOutputs(origin.x, y, sx, sy, FULL_INTERVAL);
+            left = FULL_INTERVAL;
+            span = vec2i(0, 0);
+            begin = 1;
+        }
+        for(int dx = begin; dx < extent.x; ++dx) {
+            const Interval* below = dy > 0 && dx <= prev.y ? &cells[index(origin.x + sx*dx, y - sy)] : nullptr;
+            if(below == nullptr && left.state == Interval::EMPTY) break;
+            int x = origin.x + sx*dx;
+            Interval c = EMPTY_INTERVAL;
+            if(!blockers.isBlocked(vec3i(x, y, origin.z)) && isInRange(dx, dy)) {
+                if(left.state != Interval::EMPTY)
+                    c = intersect(getFaceInterval(dx - 1, dy, false), left);
+                if(below != nullptr && below->state != Interval::EMPTY)
+                    c = unite(c, intersect(getFaceInterval(dx, dy - 1, true), *below));
+            }
+            CORE_STATS_COUNT(stats, CELLS_VISITED, 1);
+            cells[index(x, y)] = c;
+            setOutputs(x, y, sx, sy, c);
+            if(c.state != Interval::EMPTY) {
+                if(span.x > span.y) span.x = dx;
+                span.y = dx;
+            }
+            left = c;
+        }
+        rows[y] = span;
+        if(span.x > span.y) break;
+        prev = span;
+    }
+}
+
+void IntervalSolver::solve(const BlockerGrid& blockers, const vec3i& origin) {
+    CORE_ASSERT(blockers.isInside(origin), "Origin out of bounds");
+    this->origin = origin;
+    size = blockers.getSize();
+    stats.clear();
+    {
+        CORE_STATS_TIME(stats, RESET);
+        std::size_t count = std::size_t(size.x)*size.y;
+        if(cells.size() != count) cells.resize(count);
+        for(std::vector<vec2i>& rows : spans) rows.assign(size.y, vec2i(0, -1));
+        count *= size.z;
+        if(visibleOut != nullptr) visibleOut->reset(count);
+        if(fractionOut != nullptr) fractionOut->assign(count, 0);
+    }
+    CORE_STATS_TIME(stats, PROPAGATE);
+    sweepQuadrant(blockers, 1, 1);
+    sweepQuadrant(blockers, 1, -1);
+    sweepQuadrant(blockers, -1, 1);
+    sweepQuadrant(blockers, -1, -1);
+}
+
+bool IntervalSolver::isVisible(const vec3i& p) const {
+    if(p.z != origin.z) return false;
+    const vec2i& span = spans[p.x >= origin.x ? 1 : 0][p.y];
+    int dx = glm::abs(p.x - origin.x);
+    return dx >= span.x && dx <= span.y && cells[index(p.x, p.y)].state != Interval::EMPTY;
+}
+
+AngleDef IntervalSolver::getAngle(const vec3i& p) const {
+    if(!isVisible(p)) return {{0.0f, 0.0f, 0.0f}, 0.0f, false};
+    return toCone(cells[index(p.x, p.y)], p.x >= origin.x ? 1 : -1, p.y >= origin.y ? 1 : -1);
+}
+
+void IntervalSolver::getVisible(BitSet& out) const {
+    out.reset(std::size_t(size.x)*size.y*size.z);
+    for(int y = 0; y < size.y; ++y)
+        for(int side = 0; side < 2; ++side) {
+            const vec2i& span = spans[side][y];
+            int sx = side == 1 ? 1 : -1;
+            for(int dx = span.x; dx <= span.y; ++dx) {
+                int x = origin.x + sx*dx;
+                if(cells[index(x, y)].state != Interval::EMPTY)
+                    out.set(x + std::size_t(size.x)*(y + std::size_t(size.y)*origin.z));
+            }
+        }
+}
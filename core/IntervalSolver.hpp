@@ -0,0 +1,82 @@
+#ifndef INTERVALSOLVER_HPP
+#define INTERVALSOLVER_HPP
+
+#include "BlockerGrid.hpp"
+#include "ConeSolver.hpp"
+#include "BitSet.hpp"
+#include "SolverStats.hpp"
+#include <cstdint>
+
+// Visibility within the origin's z slice, the same as a ConeSolver with
+// genMode2D but without any cone math. A 2D face cone is the angle between
+// two corners of the face, and unions and intersections of such angles only
+// ever keep some of their edges, so every cone of the solve is an interval
+// between two corner directions. Corners lie on the half-cell grid, so
+// scaled by two they are integer vectors, and intervals are compared with
+// exact integer cross products instead of float tolerances.
+class IntervalSolver {
+    public:
+        // Directions from the center of the origin, in half cells. A
+        // quadrant of the slice is swept with its offsets mirrored to x >= 0
+        // and y >= 0, and its intervals are kept in that mirrored frame.
+        // Every direction of a quadrant then lies within less than half a
+        // turn, so cross products order them.
+        struct Interval {
+            enum State {
+                EMPTY = 0,
+                PARTIAL,
+                FULL
+            };
+
+            vec2i lo;
+            // Counterclockwise from lo
+            vec2i hi;
+            int state;
+        };
+
+        IntervalSolver();
+        ~IntervalSolver();
+
+        void solve(const BlockerGrid& blockers, const vec3i& origin);
+
+        const vec3i& getSize() const { return size; }
+        const vec3i& getOrigin() const { return origin; }
+        bool isVisible(const vec3i& p) const;
+        // The interval of p as a cone, like the ones a genMode2D ConeSolver
+        // keeps. Empty outside of the origin's slice.
+        AngleDef getAngle(const vec3i& p) const;
+        // Packs the visible cells of the last solution into out, indexed like
+        // the blocker grid
+        void getVisible(BitSet& out) const;
+
+        // Timers and counters of the last solve. All zero unless core is
+        // built with CORE_STATS.
+        const SolverStats& getStats() const { return stats; }
+
+        // Same as ConeSolver's
+        float maxRange = 0.0f;
+        ConeSolver::RangeMetric rangeMetric = ConeSolver::EUCLIDEAN;
+        // Same as ConeSolver's, indexed like the blocker grid. Not owned.
+        BitSet* visibleOut = nullptr;
+        std::vector<unsigned char>* fractionOut = nullptr;
+
+    private:
+        std::size_t index(int x, int y) const { return x + std::size_t(size.x)*y; }
+        bool isInRange(int dx, int dy) const;
+        void sweepQuadrant(const BlockerGrid& blockers, int sx, int sy);
+        void setOutputs(int x, int y, int sx, int sy, const Interval& c);
+        static AngleDef toCone(const Interval& c, int sx, int sy);
+
+        // Intervals of the origin's slice. Only the cells within the spans
+        // were written by the last solve; the others are stale, left over
+        // from earlier solves, so every read has to check the spans first.
+        std::vector<Interval> cells;
+        // For every row of the slice, the first and last visible |dx| on the
+        // -x side of the origin and on the +x side. x > y when there is none.
+        std::vector<vec2i> spans[2];
+        SolverStats stats;
+        vec3i size = vec3i(0);
+        vec3i origin = vec3i(0);
+};
+
+#endif //INTERVALSOLVER_HPP
@@ -0,0 +1,225 @@
+#include "OrthoSolver.hpp"
+#include <algorithm>
+#include <functional>
+
+// Diagonals shorter than this are swept on the calling thread
+#define PARALLEL_MIN_CELLS 1024
+// How many cells each parallel work item holds
+#define PARALLEL_GRAIN_CELLS 256
+
+vec3i diff2[4] = {
+    { 1,  0, 0},
+    { 0,  1, 0},
+    {-1,  0, 0},
+    { 0, -1, 0}
+};
+
+OrthoSolver::OrthoSolver() {
+}
+
+OrthoSolver::~OrthoSolver() {
+}
+
+mat4f getViewMatrixForDirection(const vec3f& direction) {
+    vec3f dummyUp = (glm::abs(glm::normalize(direction)) == vec3f(0, 1, 0))? vec3f(0,0,1) : vec3f(0, 1, 0);
+    vec3f front = glm::normalize(-direction);
+    vec3f right = glm::normalize(glm::cross(dummyUp, front));
+    vec3f up = glm::normalize(glm::cross(front, right));
+    return glm::transpose(
+        mat4f(
+            right.x, right.y, right.z, 0,
+            up.x   , up.y   , up.z   , 0,
+            front.x, front.y, front.z, 0,
+            0      , 0      , 0      , 1
+        )
+    );
+}
+
+Square OrthoSolver::getFaceSquare(int x, int y, OrthoSolver::Dir d, const vec3f& sunDir) {
+    vec3f center = vec3f(x, y, 0.0f)+vec3f(0.5f, 0.5f, 0.0f)+vec3f(diff2[d])*0.5f;
+    vec3f p[4];
+    switch(d) {
+        case UP:
+        case DOWN:
+            p[0] = center+vec3f( 0.5f, 0.0f, 0.5f);
+            p[1] = center+vec3f(-0.5f, 0.0f, 0.5f);
+            p[2] = center+vec3f( 0.5f, 0.0f,-0.5f);
+            p[3] = center+vec3f(-0.5f, 0.0f,-0.5f);
+            break;
+        case LEFT:
+        case RIGHT:
+            p[0] = center+vec3f( 0.0f, 0.5f, 0.5f);
+            p[1] = center+vec3f( 0.0f,-0.5f, 0.5f);
+            p[2] = center+vec3f( 0.0f, 0.5f,-0.5f);
+            p[3] = center+vec3f( 0.0f,-0.5f,-0.5f);
+            break;
+    }
+    mat4f viewMatrix = getViewMatrixForDirection(sunDir);
+    vec2f min = vec2f(std::numeric_limits<float>::max());
+    vec2f max = vec2f(std::numeric_limits<float>::lowest());
+    for(vec3f& v : p) {
+        v = vec3f(viewMatrix*vec4f(v, 1.0f));
+        min.x = glm::min(min.x, v.x);
+        min.y = glm::min(min.y, v.y);
+        max.x = glm::max(max.x, v.x);
+        max.y = glm::max(max.y, v.y);
+    }
+    return {min, max-min};
+}
+
+// Cells are swept in increasing distance along the sun direction. Ties are
+// broken by cell index so that the order is strict.
+bool OrthoSolver::comesBefore(const vec2i& a, const vec2i& b) const {
+    float ka = getKey(a);
+    float kb = getKey(b);
+    return ka < kb || (ka == kb && index(a) < index(b));
+}
+
+// A cell only depends on the neighbours that come before it, which are always
+// the ones one step back along x and y. So the sweep can start at the corner
+// that comes first and go one anti-diagonal at a time: the cells of a
+// diagonal only depend on the one before it.
+void OrthoSolver::updateSweep() {
+    step = vec2i(sunDir.x >= 0.0f ? 1 : -1, sunDir.y >= 0.0f ? 1 : -1);
+    start = vec2i(step.x > 0 ? 0 : size.x-1, step.y > 0 ? 0 : size.y-1);
+    // Like the original sweep, the cells of both borders the sun enters
+    // through start with the face it crosses along x
+    seedFace = step.x > 0 ? LEFT : RIGHT;
+    // The projection is linear, so face squares are just translated copies
+    // of the ones for cell (0, 0)
+    mat4f viewMatrix = getViewMatrixForDirection(sunDir);
+    faceStepX = vec2f(vec3f(viewMatrix*vec4f(1.0f, 0.0f, 0.0f, 0.0f)));
+    faceStepY = vec2f(vec3f(viewMatrix*vec4f(0.0f, 1.0f, 0.0f, 0.0f)));
+    Dir dirs[4] = {RIGHT, UP, LEFT, DOWN};
+    for(Dir d : dirs)
+        baseFaces[d] = getFaceSquare(0, 0, d, sunDir);
+}
+
+Square OrthoSolver::getCachedFaceSquare(const vec2i& p, Dir d) const {
+    return {baseFaces[d].p + faceStepX*float(p.x) + faceStepY*float(p.y), baseFaces[d].d};
+}
+
+// A cell's square is the union of what each neighbour that comes before it
+// in the sweep lets through the face they share, on top of the initial
+// square of the cells on the sun-facing borders. Neighbours are merged in
+// sweep order, so full solves and incremental updates give identical results.
+Square OrthoSolver::evaluate(const BlockerGrid& blockers, const vec2i& p) const {
+    Square s = {{0.0f, 0.0f}, {0.0f, 0.0f}};
+    if(p.x == start.x || p.y == start.y)
+        s = getCachedFaceSquare(p, seedFace);
+    // This is a blocker
+    if(blockers.isBlocked(vec3i(p, 0)))
+        return s;
+    vec2i prev[4];
+    Dir prevDir[4];
+    int count = 0;
+    Dir dirs[4] = {RIGHT, UP, LEFT, DOWN};
+    for(Dir d : dirs) {
+        vec2i f = p - vec2i(diff2[d]);
+        // Out of bountaries
+        if(f.x < 0 || f.y < 0 || f.x >= size.x || f.y >= size.y)
+            continue;
+        if(getLevel(f) >= getLevel(p))
+            continue;
+        // Insertion sort by sweep order, there's at most 4 of them
+        int i = count++;
+        for(; i > 0 && comesBefore(f, prev[i-1]); --i) {
+            prev[i] = prev[i-1];
+            prevDir[i] = prevDir[i-1];
+        }
+        prev[i] = f;
+        prevDir[i] = d;
+    }
+    for(int i = 0; i < count; ++i) {
+        Square intersection = Square::squareIntersection(
+            getCachedFaceSquare(prev[i], prevDir[i]),
+            squares[index(prev[i])]
+        );
+        s = Square::squareUnion(s, intersection);
+    }
+    return s;
+}
+
+void OrthoSolver::sweepLevel(const BlockerGrid& blockers, int level) {
+    int first = glm::max(0, level - (size.y-1));
+    int last = glm::min(level, size.x-1);
+    CORE_STATS_COUNT(stats, CELLS_VISITED, last - first + 1);
+    auto evaluateRange = [&](int begin, int end) {
+        for(int i = begin; i < end; ++i) {
+            vec2i p = start + step*vec2i(i, level - i);
+            squares[index(p)] = evaluate(blockers, p);
+        }
+    };
+    if(pool == nullptr || last - first + 1 < PARALLEL_MIN_CELLS) {
+        evaluateRange(first, last + 1);
+        return;
+    }
+    pool->parallelFor(last - first + 1, PARALLEL_GRAIN_CELLS, [&](int begin, int end, int worker) {
+        (void) worker;
+        evaluateRange(first + begin, first + end);
+    });
+}
+
+// Main algorithm!
+void OrthoSolver::solve(const BlockerGrid& blockers, const vec3f& sunDir) {
+    stats.clear();
+    vec2i newSize = vec2i(blockers.getSize());
+    if(newSize != size || sunDir != this->sunDir) {
+        CORE_STATS_TIME(stats, FACE_CONES);
+        size = newSize;
+        this->sunDir = sunDir;
+        updateSweep();
+    }
+    {
+        CORE_STATS_TIME(stats, RESET);
+        squares.assign(std::size_t(size.x)*size.y, {{0.0f, 0.0f}, {0.0f, 0.0f}});
+        queued.assign(squares.size(), 0);
+    }
+    CORE_STATS_TIME(stats, PROPAGATE);
+    for(int level = 0; level < size.x + size.y - 1; ++level)
+        sweepLevel(blockers, level);
+}
+
+// Only cells downwind of the changed cell can change. They are recomputed
+// diagonal by diagonal, and a cell is only revisited if a neighbour before it
+// changed.
+void OrthoSolver::updateBlocker(const BlockerGrid& blockers, const vec2i& changed) {
+    CORE_ASSERT(vec2i(blockers.getSize()) == size, "updateBlocker needs the grid that was last solved");
+    stats.clear();
+    CORE_STATS_TIME(stats, INCREMENTAL);
+    // Min-heap on the level, kept in a member so it isn't allocated again
+    // for every update
+    std::vector<QueueEntry>& q = queue;
+    std::greater<QueueEntry> later;
+    q.assign(1, std::make_pair(getLevel(changed), int(index(changed))));
+    queued[index(changed)] = 1;
+    CORE_STATS_COUNT(stats, QUEUE_PUSHES, 1);
+    Dir dirs[4] = {RIGHT, UP, LEFT, DOWN};
+    while(!q.empty()) {
+        std::pop_heap(q.begin(), q.end(), later);
+        int i = q.back().second;
+        q.pop_back();
+        queued[i] = 0;
+        vec2i p = vec2i(i%size.x, i/size.x);
+        CORE_STATS_COUNT(stats, CELLS_VISITED, 1);
+        Square old = squares[i];
+        squares[i] = evaluate(blockers, p);
+        if(squares[i].p == old.p && squares[i].d == old.d)
+            continue;
+        for(Dir d : dirs) {
+            vec2i n = p + vec2i(diff2[d]);
+            if(n.x < 0 || n.y < 0 || n.x >= size.x || n.y >= size.y)
+                continue;
+            if(getLevel(n) <= getLevel(p))
+                continue;
+            if(queued[index(n)]) {
+                CORE_STATS_COUNT(stats, DUPLICATE_PUSHES, 1);
+                continue;
+            }
+            queued[index(n)] = 1;
+            CORE_STATS_COUNT(stats, QUEUE_PUSHES, 1);
+            q.push_back(std::make_pair(getLevel(n), int(index(n))));
+            std::push_heap(q.begin(), q.end(), later);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef ORTHOSOLVER_HPP
+#define ORTHOSOLVER_HPP
+
+#include "BlockerGrid.hpp"
+#include "Square.hpp"
+#include "AlignedAllocator.hpp"
+#include "ThreadPool.hpp"
+#include "SolverStats.hpp"
+
+// Square propagation for a directional (orthographic) light such as the sun.
+// Works on the z = 0 slice of the blocker volume.
+class OrthoSolver {
+    public:
+        enum Dir {
+            RIGHT = 0,
+            UP,
+            LEFT,
+            DOWN
+        };
+
+        OrthoSolver();
+        ~OrthoSolver();
+
+        void solve(const BlockerGrid& blockers, const vec3f& sunDir);
+        // Brings the last solution up to date after the blocker at changed
+        // has been toggled in blockers. Gives the same result as solving again.
+        void updateBlocker(const BlockerGrid& blockers, const vec2i& changed);
+
+        const vec2i& getSize() const { return size; }
+        const Square& getSquare(const vec2i& p) const { return squares[index(p)]; }
+        bool isLit(const vec2i& p) const {
+            const Square& s = squares[index(p)];
+            return s.d.x > 0.0f || s.d.y > 0.0f;
+        }
+
+        // Timers and counters of the last solve or updateBlocker. All zero
+        // unless core is built with CORE_STATS.
+        const SolverStats& getStats() const { return stats; }
+
+        // Light-space bounds of face d of cell (x, y)
+        static Square getFaceSquare(int x, int y, Dir d, const vec3f& sunDir);
+
+        // If set, each anti-diagonal of the sweep is computed in parallel on
+        // this pool. Not owned.
+        ThreadPool* pool = nullptr;
+
+    private:
+        std::size_t index(const vec2i& p) const { return p.x + std::size_t(size.x)*p.y; }
+        float getKey(const vec2i& p) const { return glm::dot(vec2f(p), vec2f(sunDir)); }
+        // Anti-diagonal of the sweep that p belongs to
+        int getLevel(const vec2i& p) const { return glm::abs(p.x - start.x) + glm::abs(p.y - start.y); }
+        bool comesBefore(const vec2i& a, const vec2i& b) const;
+        void updateSweep();
+        Square getCachedFaceSquare(const vec2i& p, Dir d) const;
+        Square evaluate(const BlockerGrid& blockers, const vec2i& p) const;
+        void sweepLevel(const BlockerGrid& blockers, int level);
+
+        std::vector<Square, AlignedAllocator<Square>> squares;
+        std::vector<unsigned char> queued;
+        // (level, index) heap of updateBlocker
+        typedef std::pair<int, int> QueueEntry;
+        std::vector<QueueEntry> queue;
+        // Corner the sweep starts at and the direction it moves in
+        vec2i start = vec2i(0);
+        vec2i step = vec2i(1);
+        // Face whose square the cells on the sun-facing borders start with
+        Dir seedFace = RIGHT;
+        // Face squares of cell (0, 0) and how they move per cell along x and y
+        Square baseFaces[4];
+        vec2f faceStepX = vec2f(0.0f);
+        vec2f faceStepY = vec2f(0.0f);
+        vec2i size = vec2i(0);
+        vec3f sunDir = vec3f(0.0f);
+        SolverStats stats;
+};
+
+#endif //ORTHOSOLVER_HPP
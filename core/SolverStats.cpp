@@ -0,0 +1,65 @@
+#include "SolverStats.hpp"
+#include <sstream>
+
+void SolverStats::clear() {
+    for(double& s : seconds) s = 0.0;
+    for(std::uint64_t& c : counters) c = 0;
+}
+
+void SolverStats::add(const SolverStats& other) {
+    for(int i = 0; i < PHASE_COUNT; ++i) seconds[i] += other.seconds[i];
+    for(int i = 0; i < COUNTER_COUNT; ++i) counters[i] += other.counters[i];
+}
+
+const char* SolverStats::getPhaseName(Phase p) {
+    switch(p) {
+        case RESET: return "reset";
+        case FACE_CONES: return "face_cones";
+        case GATHER: return "gather";
+        case PROPAGATE: return "propagate";
+        case STORE: return "store";
+        case INCREMENTAL: return "incremental";
+        default: return "";
+    }
+}
+
+const char* SolverStats::getCounterName(Counter c) {
+    switch(c) {
+        case CELLS_VISITED: return "cells_visited";
+        case PRUNED_EMPTY: return "pruned_empty";
+        case CONE_OPS: return "cone_ops";
+        case QUEUE_PUSHES: return "queue_pushes";
+        case DUPLICATE_PUSHES: return "duplicate_pushes";
+        default: return "";
+    }
+}
+
+std::string SolverStats::toJson() const {
+    std::ostringstream s;
+    s << "{\"phases_ms\":{";
+    for(int i = 0; i < PHASE_COUNT; ++i)
+        s << (i ? "," : "") << "\"" << getPhaseName(Phase(i)) << "\":" << seconds[i]*1000.0;
+    s << "},\"counters\":{";
+    for(int i = 0; i < COUNTER_COUNT; ++i)
+        s << (i ? "," : "") << "\"" << getCounterName(Counter(i)) << "\":" << counters[i];
+    s << "}}";
+    return s.str();
+}
+
+std::string SolverStats::getCsvHeader() const {
+    std::ostringstream s;
+    for(int i = 0; i < PHASE_COUNT; ++i)
+        s << (i ? "," : "") << getPhaseName(Phase(i)) << "_ms";
+    for(int i = 0; i < COUNTER_COUNT; ++i)
+        s << "," << getCounterName(Counter(i));
+    return s.str();
+}
+
+std::string SolverStats::toCsv() const {
+    std::ostringstream s;
+    for(int i = 0; i < PHASE_COUNT; ++i)
+        s << (i ? "," : "") << seconds[i]*1000.0;
+    for(int i = 0; i < COUNTER_COUNT; ++i)
+        s << "," << counters[i];
+    return s.str();
+}
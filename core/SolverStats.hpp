@@ -0,0 +1,77 @@
+#ifndef SOLVERSTATS_HPP
+#define SOLVERSTATS_HPP
+
+#include "CoreCommons.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Time spent in each phase of the last solve or update, plus counters for
+// the work it did. Only filled in when core is built with CORE_STATS
+// (CONFIG+=core_stats), otherwise the instrumentation compiles to nothing
+// and every value stays at zero.
+struct SolverStats {
+    enum Phase {
+        RESET = 0,      // Clearing the per-cell buffers
+        FACE_CONES,     // Building the face cone table or sweep setup
+        GATHER,         // Collecting face cones and neighbour cones
+        PROPAGATE,      // Union and intersection of cones or squares
+        STORE,          // Writing the results back
+        INCREMENTAL,    // Whole updateBlocker calls
+        PHASE_COUNT
+    };
+
+    enum Counter {
+        CELLS_VISITED = 0,  // Cells whose cone or square was computed
+        PRUNED_EMPTY,       // Neighbours skipped because nothing reached them
+        CONE_OPS,           // Intersection + union pairs computed
+        QUEUE_PUSHES,       // Cells queued by incremental updates
+        DUPLICATE_PUSHES,   // Cells that were already queued
+        COUNTER_COUNT
+    };
+
+    SolverStats() { clear(); }
+
+    void clear();
+    void add(const SolverStats& other);
+
+    static const char* getPhaseName(Phase p);
+    static const char* getCounterName(Counter c);
+
+    std::string toJson() const;
+    // One line with the column names and one with the values
+    std::string getCsvHeader() const;
+    std::string toCsv() const;
+
+    double seconds[PHASE_COUNT];
+    std::uint64_t counters[COUNTER_COUNT];
+};
+
+#ifdef CORE_STATS
+    // Adds the time until the end of the scope to a phase
+    class ScopedPhaseTimer {
+        public:
+            ScopedPhaseTimer(SolverStats& stats, SolverStats::Phase phase) :
+                stats(stats), phase(phase), start(std::chrono::steady_clock::now()) {
+            }
+            ~ScopedPhaseTimer() {
+                stats.seconds[phase] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+
+        private:
+            SolverStats& stats;
+            SolverStats::Phase phase;
+            std::chrono::steady_clock::time_point start;
+    };
+
+    #define CORE_STATS_CONCAT2(a, b) a##b
+    #define CORE_STATS_CONCAT(a, b) CORE_STATS_CONCAT2(a, b)
+    #define CORE_STATS_TIME(stats, phase) \
+        ScopedPhaseTimer CORE_STATS_CONCAT(phaseTimer, __LINE__)((stats), SolverStats::phase)
+    #define CORE_STATS_COUNT(stats, counter, n) ((stats).counters[SolverStats::counter] += (n))
+#else
+    #define CORE_STATS_TIME(stats, phase) ((void)0)
+    #define CORE_STATS_COUNT(stats, counter, n) ((void)0)
+#endif
+
+#endif //SOLVERSTATS_HPP
@@ -0,0 +1,45 @@
+#include "Square.hpp"
+
+#define EPSILON 0.00001f
+
+Square Square::squareUnion(const Square& s1, const Square& s2) {
+    if(s1.p == vec2f(0.0f) && s1.d == vec2f(0.0f)) return s2;
+    else if(s2.p == vec2f(0.0f) && s2.d == vec2f(0.0f)) return s1;
+    Square s = {
+        {
+            glm::min(s1.p.x, s2.p.x),
+            glm::min(s1.p.y, s2.p.y),
+        },
+        {
+            glm::max(s1.p.x + s1.d.x, s2.p.x + s2.d.x),
+            glm::max(s1.p.y + s1.d.y, s2.p.y + s2.d.y),
+        }
+    };
+    s.d -= s.p;
+    if(glm::epsilonEqual(s.d.x*s.d.y, 0.0f, EPSILON)) return {{0.0f, 0.0f}, {0.0f, 0.0f}};
+    return s;
+}
+
+Square Square::squareIntersection(const Square& s1, const Square& s2) {
+    if((s1.p == vec2f(0.0f) && s1.d == vec2f(0.0f)) ||
+       (s2.p == vec2f(0.0f) && s2.d == vec2f(0.0f)) ||
+       s1.p.x+s1.d.x <= s2.p.x ||
+       s1.p.x >= s2.p.x+s2.d.x ||
+       s1.p.y+s1.d.y <= s2.p.y ||
+       s1.p.y >= s2.p.y+s2.d.y)
+        return {{0.0f, 0.0f}, {0.0f, 0.0f}};
+    Square s = {
+        {
+            glm::max(s1.p.x, s2.p.x),
+            glm::max(s1.p.y, s2.p.y),
+        },
+        {
+            glm::min(s1.p.x + s1.d.x, s2.p.x + s2.d.x),
+            glm::min(s1.p.y + s1.d.y, s2.p.y + s2.d.y),
+        }
+    };
+    s.d -= s.p;
+    if(glm::epsilonEqual(s.d.x*s.d.y, 0.0f, EPSILON)) return {{0.0f, 0.0f}, {0.0f, 0.0f}};
+    CORE_ASSERT(s.d.x >= 0.0f && s.d.y >= 0.0f, "Sanity check for squareIntersection");
+    return s;
+}
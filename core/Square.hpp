@@ -0,0 +1,13 @@
+#ifndef SQUARE_HPP
+#define SQUARE_HPP
+
+#include "CoreCommons.hpp"
+
+struct Square {
+    static Square squareUnion(const Square& s1, const Square& s2);
+    static Square squareIntersection(const Square& s1, const Square& s2);
+    vec2f p;
+    vec2f d;
+};
+
+#endif //SQUARE_HPP
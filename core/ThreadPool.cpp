@@ -0,0 +1,62 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(unsigned int threadCount) : nextIndex(0) {
+    if(threadCount == 0)
+        threadCount = glm::max(1u, std::thread::hardware_concurrency());
+    for(unsigned int i = 0; i < threadCount; ++i)
+        threads.push_back(std::thread(&ThreadPool::workerLoop, this, int(i)));
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for(std::thread& t : threads)
+        t.join();
+}
+
+void ThreadPool::run(int count, int grain, Job f, const void* context) {
+    if(count <= 0) return;
+    std::unique_lock<std::mutex> lock(mutex);
+    job = f;
+    jobContext = context;
+    jobCount = count;
+    jobGrain = glm::max(1, grain);
+    nextIndex = 0;
+    activeWorkers = threads.size();
+    ++generation;
+    wake.notify_all();
+    done.wait(lock, [this]() { return activeWorkers == 0; });
+    job = nullptr;
+    jobContext = nullptr;
+}
+
+void ThreadPool::workerLoop(int worker) {
+    unsigned int seen = 0;
+    while(true) {
+        Job f = nullptr;
+        const void* context = nullptr;
+        int count = 0;
+        int grain = 1;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen]() { return quit || generation != seen; });
+            if(quit) return;
+            seen = generation;
+            f = job;
+            context = jobContext;
+            count = jobCount;
+            grain = jobGrain;
+        }
+        while(true) {
+            int begin = nextIndex.fetch_add(grain);
+            if(begin >= count) break;
+            f(context, begin, glm::min(begin + grain, count), worker);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if(--activeWorkers == 0)
+            done.notify_one();
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include "CoreCommons.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Fixed set of worker threads that run parallel loops. Work is handed out
+// in chunks of grain indices through an atomic counter, so uneven items
+// balance themselves out.
+class ThreadPool {
+    public:
+        // 0 threads means one per hardware thread
+        ThreadPool(unsigned int threadCount = 0);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        unsigned int getThreadCount() const { return threads.size(); }
+
+        // Runs f over [0, count) and returns once every index is done.
+        // f(begin, end, worker) handles indices [begin, end). worker is in
+        // [0, getThreadCount()) and can be used to pick per-thread scratch
+        // data. f is called through a plain function pointer rather than
+        // wrapped in a std::function, so handing out a loop never allocates.
+        template<typename F>
+        void parallelFor(int count, int grain, const F& f) {
+            run(count, grain, &call<F>, &f);
+        }
+
+    private:
+        typedef void (*Job)(const void* f, int begin, int end, int worker);
+
+        template<typename F>
+        static void call(const void* f, int begin, int end, int worker) {
+            (*static_cast<const F*>(f))(begin, end, worker);
+        }
+        void run(int count, int grain, Job f, const void* context);
+        void workerLoop(int worker);
+
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        Job job = nullptr;
+        const void* jobContext = nullptr;
+        int jobCount = 0;
+        int jobGrain = 1;
+        std::atomic<int> nextIndex;
+        int activeWorkers = 0;
+        unsigned int generation = 0;
+        bool quit = false;
+};
+
+#endif //THREADPOOL_HPP
@@ -0,0 +1,98 @@
+#include "VisibilityCache.hpp"
+
+VisibilityCache::VisibilityCache(std::size_t memoryBudget) : memoryBudget(memoryBudget) {
+}
+
+VisibilityCache::~VisibilityCache() {
+}
+
+const BitSet* VisibilityCache::find(const BlockerGrid& blockers, const vec3i& origin) {
+    auto it = byOrigin.find(origin);
+    if(it == byOrigin.end()) {
+        ++misses;
+        return nullptr;
+    }
+    if(it->second->generation != blockers.getGeneration()) {
+        erase(it->second);
+        ++invalidations;
+        ++misses;
+        return nullptr;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    ++hits;
+    return &entries.front().visible;
+}
+
+void VisibilityCache::insert(const BlockerGrid& blockers, const vec3i& origin, const BitSet& visible) {
+    auto it = byOrigin.find(origin);
+    if(it != byOrigin.end()) erase(it->second);
+    entries.push_front({origin, blockers.getGeneration(), visible});
+    byOrigin[origin] = entries.begin();
+    memoryUsage += getEntrySize(entries.front());
+    evict();
+}
+
+// A changed cell only affects an origin's result if something from the
+// origin reached it: either it was visible, or, if it was a blocker that got
+// opened, one of its neighbours one step closer to the origin was.
+bool VisibilityCache::isAffected(const BlockerGrid& blockers, const Entry& e, const vec3i& changed) const {
+    vec3i size = blockers.getSize();
+    std::size_t i = changed.x + std::size_t(size.x)*(changed.y + std::size_t(size.y)*changed.z);
+    if(e.visible.test(i)) return true;
+    if(!volumetric && changed.z != e.origin.z) return false;
+    int axes = volumetric ? 3 : 2;
+    for(int a = 0; a < axes; ++a) {
+        if(changed[a] == e.origin[a]) continue;
+        vec3i prev = changed;
+        prev[a] -= changed[a] > e.origin[a] ? 1 : -1;
+        if(e.visible.test(prev.x + std::size_t(size.x)*(prev.y + std::size_t(size.y)*prev.z))) return true;
+    }
+    return false;
+}
+
+void VisibilityCache::blockerChanged(const BlockerGrid& blockers, const vec3i& changed) {
+    CORE_ASSERT(blockers.isInside(changed), "Blocker out of bounds");
+    std::uint64_t generation = blockers.getGeneration();
+    for(auto it = entries.begin(); it != entries.end();) {
+        auto next = std::next(it);
+        // Entries that missed an edit can't be trusted any more
+        if(it->generation + 1 != generation || isAffected(blockers, *it, changed)) {
+            erase(it);
+            ++invalidations;
+        }
+        else
+            it->generation = generation;
+        it = next;
+    }
+}
+
+void VisibilityCache::clear() {
+    entries.clear();
+    byOrigin.clear();
+    memoryUsage = 0;
+}
+
+void VisibilityCache::setMemoryBudget(std::size_t bytes) {
+    memoryBudget = bytes;
+    evict();
+}
+
+void VisibilityCache::resetStats() {
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+    invalidations = 0;
+}
+
+void VisibilityCache::erase(EntryList::iterator it) {
+    memoryUsage -= getEntrySize(*it);
+    byOrigin.erase(it->origin);
+    entries.erase(it);
+}
+
+void VisibilityCache::evict() {
+    while(memoryUsage > memoryBudget && !entries.empty()) {
+        erase(std::prev(entries.end()));
+        ++evictions;
+    }
+}
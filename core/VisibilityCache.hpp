@@ -0,0 +1,73 @@
+#ifndef VISIBILITYCACHE_HPP
+#define VISIBILITYCACHE_HPP
+
+#include "BlockerGrid.hpp"
+#include "BitSet.hpp"
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+
+// Least recently used cache of the visible cells from each origin, for
+// origins that get asked for again and again. An entry is only valid for the
+// generation of the blocker grid it was computed with. Edits reported
+// through blockerChanged move the entries they can't affect on to the new
+// generation, so only the ones that actually see the change are recomputed.
+// All entries must come from solves with the same settings.
+class VisibilityCache {
+    public:
+        // memoryBudget is in bytes, counting the stored bits and bookkeeping
+        VisibilityCache(std::size_t memoryBudget);
+        ~VisibilityCache();
+
+        // Cells visible from origin, or nullptr if there is no entry for the
+        // current generation of blockers. The pointer is valid until the
+        // cache is changed.
+        const BitSet* find(const BlockerGrid& blockers, const vec3i& origin);
+        void insert(const BlockerGrid& blockers, const vec3i& origin, const BitSet& visible);
+        // Must be called after every single edit to blockers, otherwise every
+        // entry is considered stale
+        void blockerChanged(const BlockerGrid& blockers, const vec3i& changed);
+        void clear();
+
+        void setMemoryBudget(std::size_t bytes);
+        std::size_t getMemoryBudget() const { return memoryBudget; }
+        std::size_t getMemoryUsage() const { return memoryUsage; }
+        std::size_t size() const { return entries.size(); }
+
+        std::uint64_t getHits() const { return hits; }
+        std::uint64_t getMisses() const { return misses; }
+        // Entries dropped to stay within the memory budget
+        std::uint64_t getEvictions() const { return evictions; }
+        // Entries dropped because the blockers changed under them
+        std::uint64_t getInvalidations() const { return invalidations; }
+        double getHitRate() const { return hits + misses == 0 ? 0.0 : double(hits)/double(hits + misses); }
+        void resetStats();
+
+        // Same meaning as the ConeSolver setting used for the cached solves
+        bool volumetric = false;
+
+    private:
+        struct Entry {
+            vec3i origin;
+            std::uint64_t generation;
+            BitSet visible;
+        };
+        typedef std::list<Entry> EntryList;
+
+        static std::size_t getEntrySize(const Entry& e) { return sizeof(Entry) + e.visible.getMemoryUsage(); }
+        bool isAffected(const BlockerGrid& blockers, const Entry& e, const vec3i& changed) const;
+        void erase(EntryList::iterator it);
+        void evict();
+
+        // Most recently used first
+        EntryList entries;
+        std::unordered_map<vec3i, EntryList::iterator> byOrigin;
+        std::size_t memoryBudget;
+        std::size_t memoryUsage = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        std::uint64_t invalidations = 0;
+};
+
+#endif //VISIBILITYCACHE_HPP
@@ -0,0 +1,6 @@
+INCLUDEPATH += $$PWD/..
+DEPENDPATH += $$PWD
+core_stats: DEFINES += CORE_STATS
+
+LIBS += -L$$OUT_PWD/../core/ -lcore -lpthread
+PRE_TARGETDEPS += $$OUT_PWD/../core/libcore.a
@@ -0,0 +1,55 @@
+CONFIG -= qt
+
+TARGET = core
+
+TEMPLATE = lib
+CONFIG += staticlib
+
+QMAKE_CXXFLAGS += -std=c++0x -fno-exceptions -pthread
+# Lets the AngleBatch kernels vectorize, and keeps them from fusing
+# multiply-adds so they match the scalar AngleDef code bit for bit
+QMAKE_CXXFLAGS += -ftree-vectorize -fno-math-errno -fno-trapping-math -ffp-contract=off
+CONFIG(release, debug|release): DEFINES += NDEBUG
+# Per-phase solver timers and counters, see SolverStats.hpp
+core_stats: DEFINES += CORE_STATS
+
+# Only the header-only glm bundled with VBE is used, nothing that needs GL
+INCLUDEPATH += . ../VBE/include
+
+SOURCES += \
+    AngleDef.cpp \
+    AngleBatch.cpp \
+    Cone.cpp \
+    ConeBuffer.cpp \
+    FaceConeTable.cpp \
+    SolverStats.cpp \
+    BlockerGrid.cpp \
+    ChunkedBlockers.cpp \
+    ConeSolver.cpp \
+    BitSet.cpp \
+    ThreadPool.cpp \
+    BatchSolver.cpp \
+    VisibilityCache.cpp \
+    Square.cpp \
+    OrthoSolver.cpp \
+    IntervalSolver.cpp
+
+HEADERS += \
+    CoreCommons.hpp \
+    AlignedAllocator.hpp \
+    AngleDef.hpp \
+    AngleBatch.hpp \
+    Cone.hpp \
+    ConeBuffer.hpp \
+    FaceConeTable.hpp \
+    SolverStats.hpp \
+    BlockerGrid.hpp \
+    ChunkedBlockers.hpp \
+    ConeSolver.hpp \
+    BitSet.hpp \
+    ThreadPool.hpp \
+    BatchSolver.hpp \
+    VisibilityCache.hpp \
+    Square.hpp \
+    OrthoSolver.hpp \
+    IntervalSolver.hpp
@@ -2,52 +2,42 @@
 #define GRID_HPP
 
 #include "Angle.hpp"
+#include <core/ConeSolver.hpp>
 
 class Grid : public GameObject {
     public:
-        Grid();
+        Grid(const vec3i& size);
         ~Grid();
 
     private:
-        struct Cell {
-            bool block = false;
-            Angle* angle = nullptr;
-        };
-
-        enum Face {
-            MINX = 0,
-            MAXX,
-            MINY,
-            MAXY,
-            MINZ,
-            MAXZ,
-        };
-
-        AngleDef getAngle(vec3i pos, Face f, vec3i origin) const;
-
-        void resetCells();
         void initGridTex();
         void initQuadMesh();
         void initLinesMesh();
 
+        vec2i getSize() const;
+        vec2f getBoardSize() const;
         vec2f getRelPos() const;
         vec2i getMouseCellCoords() const;
         void toggleBlock();
 
         void calcAngles();
         void updateGridTex();
+        void updateHoveredAngle();
 
         void update(float deltaTime) override;
         void draw() const override;
 
-        std::vector<std::vector<Cell>> cells;
+        Angle* hoveredAngle = nullptr;
+        vec2i hoveredCell = vec2i(-1);
+        BlockerGrid blockers;
+        ConeSolver solver;
+        // Filled by the solver, the cones are only read for the hovered cell
+        BitSet visible;
         Texture2D gridTex;
         mutable MeshIndexed quad;
         mutable Mesh lines;
 
-        vec3i origin = {16, 16, 16};
-        bool genMode2D = false;
-        bool approxMode = false;
+        vec3i origin;
 };
 
 #endif //GRID_HPP
@@ -2,41 +2,22 @@
 #define GRIDORTHO_HPP
 
 #include "commons.hpp"
-
-struct Square {
-    static Square squareUnion(const Square& s1, const Square& s2);
-    static Square squareIntersection(const Square& s1, const Square& s2);
-    vec2f p;
-    vec2f d;
-};
+#include <core/OrthoSolver.hpp>
 
 const Log&operator << (const Log& log, const Square& s);
 
 class GridOrtho : public GameObject {
     public:
-        GridOrtho();
+        GridOrtho(const vec2i& size);
         ~GridOrtho();
 
     private:
-        struct Cell {
-            bool block = false;
-            Square sq;
-        };
-
-        enum Dir {
-            RIGHT = 0,
-            UP,
-            LEFT,
-            DOWN
-        };
-
-        Square getSquare(int x, int y, Dir d) const;
-
-        void resetCells();
         void initGridTex();
         void initQuadMesh();
         void initLinesMesh();
 
+        vec2i getSize() const;
+        vec2f getBoardSize() const;
         vec2f getRelPos() const;
         vec2i getMouseCellCoords() const;
         void toggleBlock();
@@ -47,7 +28,8 @@ class GridOrtho : public GameObject {
         void update(float deltaTime) override;
         void draw() const override;
 
-        std::vector<std::vector<Cell>> cells;
+        BlockerGrid blockers;
+        OrthoSolver solver;
         Texture2D gridTex;
         mutable MeshIndexed quad;
         mutable Mesh lines;
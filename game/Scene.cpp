@@ -35,10 +35,10 @@ Scene::Scene() {
     camera = new Camera("mainCamera");
     camera->addTo(this);
 
-    Grid* g = new Grid();
+    Grid* g = new Grid(vec3i(33, 33, 1));
     g->addTo(this);
 
-    GridOrtho* g2 = new GridOrtho();
+    GridOrtho* g2 = new GridOrtho(vec2i(33, 33));
     g2->addTo(this);
 }
 
@@ -5,6 +5,7 @@ CONFIG -= app_bundle
 
 TEMPLATE = app
 
+include(../core/core.pri)
 include(../VBE-Scenegraph/VBE-Scenegraph.pri)
 include(../VBE-Profiler/VBE-Profiler.pri)
 include(../VBE/VBE.pri)
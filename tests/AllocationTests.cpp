@@ -0,0 +1,50 @@
+#include "Test.hpp"
+#include "Helpers.hpp"
+#include "Benchmark.hpp"
+#include <memory>
+
+// The timed loop of a benchmark, as the harness runs it, around f
+template<typename F>
+static BenchmarkState runLoop(F f) {
+    BenchmarkState state(8);
+    state.expectNoAllocations();
+    while(state.keepRunning()) f();
+    return state;
+}
+
+// Solving the same grid again reuses every buffer of the previous solve
+TEST(steadySolveDoesNotAllocate) {
+    for(int m = 0; m < CONE_MODE_COUNT; ++m) {
+        ConeMode mode = ConeMode(m);
+        vec3i size = getModeSize(mode);
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, Maps::CAVES, size/2);
+        ConeSolver solver;
+        setMode(solver, mode);
+        solver.solve(blockers, size/2);
+        BenchmarkState state = runLoop([&]() { solver.solve(blockers, size/2); });
+        CHECK_CONTEXT(state.getAllocations() == 0, getModeName(mode) << " " << state.getAllocations() << " allocations");
+    }
+}
+
+// Blocks from AlignedAllocator never go through operator new, so this only
+// passes if the bench counts them too
+TEST(alignedAllocationsAreCounted) {
+    BitSet bits;
+    std::size_t count = 1024;
+    BenchmarkState state = runLoop([&]() { bits.reset(count *= 2); });
+    CHECK(state.getAllocations() > 0);
+}
+
+// A solve on a bigger grid than the last one has to grow its cone buffers,
+// and has to be reported as allocating
+TEST(reallocatingSolveIsReported) {
+    std::vector<std::unique_ptr<BlockerGrid>> grids;
+    for(int i = 0; i < 8; ++i) grids.emplace_back(new BlockerGrid(vec3i(32 << i, 32, 1)));
+    ConeSolver solver;
+    solver.genMode2D = true;
+    int next = 0;
+    BenchmarkState state = runLoop([&]() { solver.solve(*grids[next], vec3i(0)); ++next; });
+    CHECK(state.getExpectsNoAllocations());
+    CHECK(state.getAllocations() > 0);
+}
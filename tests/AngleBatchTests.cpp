@@ -0,0 +1,88 @@
+#include "Test.hpp"
+#include <core/AngleBatch.hpp>
+#include <cstring>
+#include <random>
+
+// Not a multiple of any kernel's lanes, so the padding is exercised too
+static const std::size_t BATCH_SIZE = 1007;
+
+template<typename T>
+static bool sameBits(const BasicAngleDef<T>& a, const BasicAngleDef<T>& b) {
+    return a.full == b.full && std::memcmp(&a.dir, &b.dir, sizeof(a.dir)) == 0 &&
+           std::memcmp(&a.halfAngle, &b.halfAngle, sizeof(a.halfAngle)) == 0;
+}
+
+template<typename T>
+static typename BasicAngleDef<T>::Vec3 getRandomDir(std::mt19937& random) {
+    std::normal_distribution<T> normal;
+    typename BasicAngleDef<T>::Vec3 v;
+    do v = typename BasicAngleDef<T>::Vec3(normal(random), normal(random), normal(random));
+    while(glm::length(v) < T(0.001));
+    return glm::normalize(v);
+}
+
+// Mostly ordinary cones, plus the cases the kernels handle with selects
+// instead of branches: full and empty cones, the same, opposite and nearly
+// the same directions, and cones too thin or too wide to matter
+template<typename T>
+static void getRandomPair(std::mt19937& random, BasicAngleDef<T>& a, BasicAngleDef<T>& b) {
+    std::uniform_real_distribution<T> tanHalf(T(0), T(4));
+    a = {getRandomDir<T>(random), tanHalf(random), false};
+    b = {getRandomDir<T>(random), tanHalf(random), false};
+    switch(random()%10) {
+        case 0: a.full = true; break;
+        case 1: b.full = true; break;
+        case 2: a.halfAngle = T(0); break;
+        case 3: b.dir = a.dir; break;
+        case 4: b.dir = -a.dir; break;
+        case 5: b.dir = glm::normalize(a.dir + getRandomDir<T>(random)*T(1e-7)); break;
+        case 6: a.halfAngle = T(1e-9); b.dir = a.dir; break;
+        case 7: a.halfAngle = T(1e9); break;
+        default: break;
+    }
+}
+
+template<typename T>
+static void checkKernels(std::mt19937& random) {
+    typedef BasicAngleDef<T> Angle;
+    typedef BasicAngleBatch<T> Batch;
+    Batch a, b, result;
+    a.reset(BATCH_SIZE);
+    b.reset(BATCH_SIZE);
+    std::vector<Angle> scalarA(BATCH_SIZE), scalarB(BATCH_SIZE);
+    for(int round = 0; round < 20; ++round) {
+        for(std::size_t i = 0; i < BATCH_SIZE; ++i) {
+            getRandomPair(random, scalarA[i], scalarB[i]);
+            a.set(i, scalarA[i]);
+            b.set(i, scalarB[i]);
+        }
+        for(int k = 0; k < Batch::getKernelCount(); ++k) {
+            if(!Batch::isKernelSupported(k)) continue;
+            Batch::useKernel(k);
+            std::size_t wrongUnion = 0, wrongIntersection = 0, wrongOverlap = 0;
+            result.reset(BATCH_SIZE);
+            Batch::angleUnion(a, b, result);
+            for(std::size_t i = 0; i < BATCH_SIZE; ++i)
+                wrongUnion += !sameBits(result.get(i), Angle::angleUnion(scalarA[i], scalarB[i]));
+            Batch::angleIntersection(a, b, result);
+            for(std::size_t i = 0; i < BATCH_SIZE; ++i)
+                wrongIntersection += !sameBits(result.get(i), Angle::angleIntersection(scalarA[i], scalarB[i]));
+            std::vector<int> overlap;
+            Batch::overlapTest(a, b, overlap);
+            for(std::size_t i = 0; i < BATCH_SIZE; ++i)
+                wrongOverlap += overlap[i] != int(Angle::overlapTest(scalarA[i], scalarB[i]));
+            CHECK_CONTEXT(wrongUnion == 0, Batch::getKernelName(k) << " union " << wrongUnion << " wrong");
+            CHECK_CONTEXT(wrongIntersection == 0, Batch::getKernelName(k) << " intersection " << wrongIntersection << " wrong");
+            CHECK_CONTEXT(wrongOverlap == 0, Batch::getKernelName(k) << " overlap " << wrongOverlap << " wrong");
+        }
+    }
+    Batch::useKernel(-1);
+}
+
+// Every kernel set this CPU can run, not only the one picked for it, so the
+// ones other machines pick are checked as well
+TEST(angleBatchMatchesScalar) {
+    std::mt19937 random(7);
+    checkKernels<float>(random);
+    checkKernels<double>(random);
+}
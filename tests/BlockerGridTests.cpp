@@ -0,0 +1,39 @@
+#include "Test.hpp"
+#include "Helpers.hpp"
+#include <cstdio>
+
+// A loaded map only gets its brick summary when something needs it, and
+// must then have the same one as the grid it was saved from, edits included
+TEST(loadedBricksMatchGrid) {
+    std::string path = "/tmp/tests-blockers.map";
+    for(Maps::Kind map : ALL_MAPS) {
+        vec3i size = vec3i(37, 20, 19);
+        vec3i origin = vec3i(10);
+        BlockerGrid saved(size);
+        Maps::generate(saved, map, origin);
+        CHECK(saved.save(path));
+        BlockerGrid loaded(vec3i(1));
+        CHECK(loaded.load(path));
+        CHECK(!loaded.hasBricks());
+        // Edits before the summary exists are counted when it is built
+        loaded.toggle(vec3i(36, 19, 18));
+        saved.toggle(vec3i(36, 19, 18));
+        ConeSolver fromLoaded;
+        ConeSolver fromSaved;
+        fromLoaded.volumetric = fromSaved.volumetric = true;
+        fromLoaded.sparseFrontier = fromSaved.sparseFrontier = true;
+        fromLoaded.solve(loaded, origin);
+        fromSaved.solve(saved, origin);
+        CHECK(loaded.hasBricks());
+        CHECK_CONTEXT(countDifferentCones(fromLoaded, fromSaved) == 0, Maps::getName(map));
+        loaded.toggle(vec3i(3, 4, 5));
+        saved.toggle(vec3i(3, 4, 5));
+        std::size_t differentBricks = 0;
+        for(int z = 0; z < size.z; ++z)
+            for(int y = 0; y < size.y; ++y)
+                for(int x = 0; x < size.x; ++x)
+                    differentBricks += loaded.getBrickState(vec3i(x, y, z)) != saved.getBrickState(vec3i(x, y, z));
+        CHECK_CONTEXT(differentBricks == 0, Maps::getName(map));
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,75 @@
+#include "Test.hpp"
+#include "Helpers.hpp"
+#include <core/ChunkedBlockers.hpp>
+#include <set>
+
+// Most chunks a solve should ever need at once: those that hold a cell of
+// a single shell, which is all the solver prepares at a time
+static std::size_t getShellChunkBound(const vec3i& size, const vec3i& origin, int chunkShift, bool volumetric) {
+    std::vector<std::set<vec3i, bool (*)(const vec3i&, const vec3i&)>> shells;
+    auto less = [](const vec3i& a, const vec3i& b) {
+        return a.z != b.z ? a.z < b.z : a.y != b.y ? a.y < b.y : a.x < b.x;
+    };
+    for(int z = 0; z < size.z; ++z)
+        for(int y = 0; y < size.y; ++y)
+            for(int x = 0; x < size.x; ++x) {
+                if(!volumetric && z != origin.z) continue;
+                vec3i offset = glm::abs(vec3i(x, y, z) - origin);
+                std::size_t d = std::size_t(offset.x + offset.y + offset.z);
+                while(shells.size() <= d) shells.emplace_back(less);
+                shells[d].insert(vec3i(x >> chunkShift, y >> chunkShift, z >> chunkShift));
+            }
+    std::size_t bound = 0;
+    for(const auto& shell : shells) bound = std::max(bound, shell.size());
+    return bound;
+}
+
+// Paging blockers in chunk by chunk must give the same cones as solving the
+// grid they come from, including with chunks that are cut short by the end
+// of the world and with planar solves on a single slice of a deeper world
+TEST(chunkedSolveMatchesGrid) {
+    struct Case {
+        ConeMode mode;
+        vec3i size;
+        int chunkShift;
+    };
+    const Case cases[] = {
+        {VOLUMETRIC, vec3i(20), 3},
+        {VOLUMETRIC, vec3i(37, 21, 18), 4},
+        {PLANAR_2D, vec3i(100, 75, 5), 5},
+        {PLANAR_3D, vec3i(70, 45, 3), 3},
+    };
+    for(const Case& c : cases)
+        for(Maps::Kind map : ALL_MAPS)
+            for(int sparse = 0; sparse < 2; ++sparse)
+                for(const vec3i& origin : getOrigins(c.size)) {
+                    BlockerGrid source(c.size);
+                    Maps::generate(source, map, origin);
+                    GridChunkProvider provider(source);
+                    ChunkedBlockers chunked(provider, c.size, c.chunkShift);
+                    ConeSolver reference;
+                    ConeSolver solver;
+                    setMode(reference, c.mode);
+                    setMode(solver, c.mode);
+                    reference.sparseFrontier = solver.sparseFrontier = sparse != 0;
+                    solver.rollingShells = true;
+                    std::size_t count = std::size_t(c.size.x)*c.size.y*c.size.z;
+                    std::vector<AngleDef> sunk(count, {{0.0f, 0.0f, 0.0f}, 0.0f, false});
+                    solver.sink = [&](const vec3i& p, const AngleDef& cone) {
+                        sunk[p.x + std::size_t(c.size.x)*(p.y + std::size_t(c.size.y)*p.z)] = cone;
+                    };
+                    reference.solve(source, origin);
+                    solver.solve(chunked, origin);
+                    std::size_t differentCones = 0;
+                    for(std::size_t i = 0; i < count; ++i)
+                        differentCones += !sameCone(sunk[i], reference.getCones().get(i));
+                    std::size_t bound = getShellChunkBound(c.size, origin, c.chunkShift, c.mode == VOLUMETRIC);
+                    std::ostringstream context;
+                    context << getModeName(c.mode) << " " << c.size.x << "x" << c.size.y << "x" << c.size.z <<
+                               " chunks of " << (1 << c.chunkShift) << " " << Maps::getName(map) <<
+                               (sparse ? " sparse" : "") << " origin " << origin.x << " " << origin.y << " " << origin.z;
+                    CHECK_CONTEXT(differentCones == 0, context.str());
+                    CHECK_CONTEXT(chunked.getPeakResidentCount() <= bound,
+                                  context.str() << " peak " << chunked.getPeakResidentCount() << " of " << bound);
+                }
+}
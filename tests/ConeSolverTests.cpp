@@ -0,0 +1,192 @@
+#include "Test.hpp"
+#include "Helpers.hpp"
+#include <core/ThreadPool.hpp>
+
+// Toggles random blockers one at a time, bringing a solution up to date with
+// updateBlocker after each, and compares it cell by cell with solving the
+// same blockers again
+TEST(updateBlockerMatchesSolve) {
+    std::mt19937 random(42);
+    for(int m = 0; m < CONE_MODE_COUNT; ++m)
+        for(Maps::Kind map : ALL_MAPS) {
+            ConeMode mode = ConeMode(m);
+            vec3i size = getModeSize(mode);
+            for(const vec3i& origin : getOrigins(size)) {
+                BlockerGrid blockers(size);
+                Maps::generate(blockers, map, origin);
+                ConeSolver updated;
+                ConeSolver solved;
+                setMode(updated, mode);
+                setMode(solved, mode);
+                updated.solve(blockers, origin);
+                for(int i = 0; i < 16; ++i) {
+                    vec3i changed = getRandomCell(random, size, origin, mode == VOLUMETRIC);
+                    blockers.toggle(changed);
+                    updated.updateBlocker(blockers, changed);
+                    solved.solve(blockers, origin);
+                    BitSet a, b;
+                    updated.getVisible(a);
+                    solved.getVisible(b);
+                    CHECK_CONTEXT(countDifferences(a, b) == 0,
+                                  getModeName(mode) << " " << Maps::getName(map) << " toggle " << i);
+                    CHECK_CONTEXT(countDifferentCones(updated, solved) == 0,
+                                  getModeName(mode) << " " << Maps::getName(map) << " toggle " << i);
+                }
+            }
+        }
+}
+
+// Shells are only split across the pool once they have enough cells, so the
+// planar maps are wide enough for their outer shells to be split, and so is
+// the volume for most of its shells
+TEST(parallelSolveMatchesSerial) {
+    ThreadPool pool(4);
+    for(int m = 0; m < CONE_MODE_COUNT; ++m)
+        for(Maps::Kind map : ALL_MAPS)
+            for(int sparse = 0; sparse < 2; ++sparse) {
+                ConeMode mode = ConeMode(m);
+                vec3i size = mode == VOLUMETRIC ? vec3i(40) : vec3i(600, 600, 1);
+                vec3i origin = size/2/4*4;
+                BlockerGrid blockers(size);
+                Maps::generate(blockers, map, origin);
+                ConeSolver serial;
+                ConeSolver parallel;
+                setMode(serial, mode);
+                setMode(parallel, mode);
+                serial.sparseFrontier = parallel.sparseFrontier = sparse != 0;
+                parallel.pool = &pool;
+                serial.solve(blockers, origin);
+                parallel.solve(blockers, origin);
+                CHECK_CONTEXT(countDifferentCones(serial, parallel) == 0,
+                              getModeName(mode) << " " << Maps::getName(map) << (sparse ? " sparse" : ""));
+            }
+}
+
+// The sparse frontier only skips cells nothing reaches, so it must give the
+// same cones as sweeping every cell, with and without a range limit
+TEST(sparseFrontierMatchesDense) {
+    for(int m = 0; m < CONE_MODE_COUNT; ++m)
+        for(Maps::Kind map : ALL_MAPS)
+            for(float range : {0.0f, 9.5f}) {
+                ConeMode mode = ConeMode(m);
+                vec3i size = getModeSize(mode);
+                for(const vec3i& origin : getOrigins(size)) {
+                    BlockerGrid blockers(size);
+                    Maps::generate(blockers, map, origin);
+                    ConeSolver dense;
+                    ConeSolver sparse;
+                    setMode(dense, mode);
+                    setMode(sparse, mode);
+                    dense.maxRange = sparse.maxRange = range;
+                    sparse.sparseFrontier = true;
+                    dense.solve(blockers, origin);
+                    sparse.solve(blockers, origin);
+                    BitSet a, b;
+                    dense.getVisible(a);
+                    sparse.getVisible(b);
+                    CHECK_CONTEXT(countDifferences(a, b) == 0, getModeName(mode) << " " << Maps::getName(map) <<
+                                  " range " << range << " origin " << origin.x << " " << origin.y << " " << origin.z);
+                    CHECK_CONTEXT(countDifferentCones(dense, sparse) == 0, getModeName(mode) << " " << Maps::getName(map) <<
+                                  " range " << range << " origin " << origin.x << " " << origin.y << " " << origin.z);
+                }
+            }
+}
+
+// Keeping only the last two shells must not change what the sink and the
+// outputs get: every cell once, with the cone a solve keeping the whole
+// volume ends up with
+TEST(rollingShellsMatchFullSolve) {
+    for(int m = 0; m < CONE_MODE_COUNT; ++m)
+        for(Maps::Kind map : ALL_MAPS)
+            for(int sparse = 0; sparse < 2; ++sparse) {
+                ConeMode mode = ConeMode(m);
+                vec3i size = getModeSize(mode);
+                for(const vec3i& origin : getOrigins(size)) {
+                    BlockerGrid blockers(size);
+                    Maps::generate(blockers, map, origin);
+                    ConeSolver full;
+                    ConeSolver rolling;
+                    setMode(full, mode);
+                    setMode(rolling, mode);
+                    full.sparseFrontier = rolling.sparseFrontier = sparse != 0;
+                    rolling.rollingShells = true;
+                    BitSet visible, rollingVisible;
+                    std::vector<unsigned char> fraction, rollingFraction;
+                    full.fractionOut = &fraction;
+                    rolling.visibleOut = &rollingVisible;
+                    rolling.fractionOut = &rollingFraction;
+                    std::size_t count = std::size_t(size.x)*size.y*size.z;
+                    std::vector<AngleDef> sunk(count, {{0.0f, 0.0f, 0.0f}, 0.0f, false});
+                    std::vector<int> sinkCalls(count, 0);
+                    rolling.sink = [&](const vec3i& p, const AngleDef& cone) {
+                        std::size_t i = p.x + std::size_t(size.x)*(p.y + std::size_t(size.y)*p.z);
+                        sunk[i] = cone;
+                        ++sinkCalls[i];
+                    };
+                    full.solve(blockers, origin);
+                    rolling.solve(blockers, origin);
+                    full.getVisible(visible);
+                    std::size_t differentCones = 0;
+                    std::size_t repeated = 0;
+                    for(std::size_t i = 0; i < count; ++i) {
+                        differentCones += !sameCone(sunk[i], full.getCones().get(i));
+                        repeated += sinkCalls[i] > 1;
+                    }
+                    std::ostringstream context;
+                    context << getModeName(mode) << " " << Maps::getName(map) << (sparse ? " sparse" : "") <<
+                               " origin " << origin.x << " " << origin.y << " " << origin.z;
+                    CHECK_CONTEXT(differentCones == 0, context.str());
+                    CHECK_CONTEXT(repeated == 0, context.str());
+                    CHECK_CONTEXT(countDifferences(visible, rollingVisible) == 0, context.str());
+                    CHECK_CONTEXT(fraction == rollingFraction, context.str());
+                }
+            }
+}
+
+// Rolling solves must not need memory in proportion to the volume: doubling
+// the side of a cube may at most multiply it by four, where keeping a cone
+// or a face cone per cell would multiply it by eight. Solves are range
+// limited so that the big volumes stay quick; what they keep doesn't
+// depend on the range. The bigger one must also take a fraction of a
+// cone per cell.
+TEST(rollingShellsMemoryFollowsFaces) {
+    std::size_t usage[2];
+    for(int i = 0; i < 2; ++i) {
+        int n = 96 << i;
+        vec3i size = vec3i(n);
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, Maps::CAVES, size/2);
+        ConeSolver solver;
+        setMode(solver, VOLUMETRIC);
+        solver.rollingShells = true;
+        solver.sparseFrontier = true;
+        solver.maxRange = 12.0f;
+        solver.solve(blockers, size/2);
+        usage[i] = solver.getMemoryUsage();
+    }
+    std::size_t volume = std::size_t(192)*192*192*(4*sizeof(float) + 1);
+    CHECK_CONTEXT(usage[1] < volume/4, "192^3 takes " << usage[1] << " bytes");
+    CHECK_CONTEXT(usage[1] <= usage[0]*4, usage[0] << " bytes for 96^3, " << usage[1] << " for 192^3");
+}
+
+// Face cones past the extent rolling solves keep a table for are computed
+// on the spot, and must be the same as the ones in a full table
+TEST(rollingShellsMatchFullSolveBeyondTable) {
+    vec3i size = vec3i(72);
+    for(Maps::Kind map : {Maps::OPEN, Maps::CAVES}) {
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, map, vec3i(0));
+        ConeSolver full;
+        ConeSolver rolling;
+        setMode(full, VOLUMETRIC);
+        setMode(rolling, VOLUMETRIC);
+        rolling.rollingShells = true;
+        std::size_t differentCones = 0;
+        rolling.sink = [&](const vec3i& p, const AngleDef& cone) {
+            differentCones += !sameCone(cone, full.getAngle(p));
+        };
+        full.solve(blockers, vec3i(0));
+        rolling.solve(blockers, vec3i(0));
+        CHECK_CONTEXT(differentCones == 0, Maps::getName(map));
+    }
+}
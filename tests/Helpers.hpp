@@ -0,0 +1,82 @@
+#ifndef HELPERS_HPP
+#define HELPERS_HPP
+
+#include "Maps.hpp"
+#include <core/ConeSolver.hpp>
+#include <random>
+
+// The solver settings and volumes the tests go through. They are small so
+// that comparing every cell against a fresh solve stays quick.
+enum ConeMode {
+    PLANAR_2D = 0,
+    PLANAR_3D,
+    VOLUMETRIC,
+    CONE_MODE_COUNT
+};
+
+static const Maps::Kind ALL_MAPS[4] = {Maps::OPEN, Maps::RANDOM, Maps::CORRIDORS, Maps::CAVES};
+
+inline const char* getModeName(ConeMode mode) {
+    switch(mode) {
+        case PLANAR_2D: return "2D";
+        case PLANAR_3D: return "3D faces";
+        case VOLUMETRIC: return "volumetric";
+        default: break;
+    }
+    return "";
+}
+
+inline vec3i getModeSize(ConeMode mode) {
+    return mode == VOLUMETRIC ? vec3i(20) : vec3i(64, 64, 1);
+}
+
+template<typename T>
+void setMode(BasicConeSolver<T>& solver, ConeMode mode) {
+    solver.genMode2D = mode == PLANAR_2D;
+    solver.volumetric = mode == VOLUMETRIC;
+}
+
+// The center, a corner and a cell off every axis and border
+inline std::vector<vec3i> getOrigins(const vec3i& size) {
+    std::vector<vec3i> origins;
+    origins.push_back(size/2/4*4);
+    origins.push_back(vec3i(0));
+    origins.push_back(glm::min(vec3i(5, 7, 3), size - 1));
+    return origins;
+}
+
+// Blocker to toggle next, anywhere in the origin's slice unless volumetric,
+// never the origin itself
+inline vec3i getRandomCell(std::mt19937& random, const vec3i& size, const vec3i& origin, bool volumetric) {
+    while(true) {
+        vec3i p(int(random()%size.x), int(random()%size.y), volumetric ? int(random()%size.z) : origin.z);
+        if(p != origin) return p;
+    }
+}
+
+inline std::size_t countDifferences(const BitSet& a, const BitSet& b) {
+    if(a.size() != b.size()) return std::max(a.size(), b.size());
+    std::size_t differences = 0;
+    for(std::size_t i = 0; i < a.size(); ++i)
+        differences += a.test(i) != b.test(i);
+    return differences;
+}
+
+template<typename T>
+bool sameCone(const BasicAngleDef<T>& a, const BasicAngleDef<T>& b) {
+    return a.full == b.full && a.halfAngle == b.halfAngle && a.dir == b.dir;
+}
+
+// Cells whose cones aren't the same bit for bit
+template<typename T>
+std::size_t countDifferentCones(const BasicConeSolver<T>& a, const BasicConeSolver<T>& b) {
+    const BasicConeBuffer<T>& ca = a.getCones();
+    const BasicConeBuffer<T>& cb = b.getCones();
+    if(ca.size() != cb.size()) return std::max(ca.size(), cb.size());
+    std::size_t differences = 0;
+    for(std::size_t i = 0; i < ca.size(); ++i)
+        differences += !sameCone(ca.get(i), cb.get(i));
+    return differences;
+}
+
+#endif //HELPERS_HPP
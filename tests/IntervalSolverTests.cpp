@@ -0,0 +1,59 @@
+#include "Test.hpp"
+#include "Helpers.hpp"
+#include <core/IntervalSolver.hpp>
+
+// The interval solver keeps the exact cones a genMode2D cone solve would
+// have with no rounding. No difference in visibility is allowed: not with
+// ConeSolverDouble, whose tolerances are far below anything these sizes
+// can produce, and not with the float ConeSolver either, which loses no
+// cell on these maps. Cells are compared one by one, whatever their cone.
+TEST(intervalSolveMatchesConeSolve) {
+    struct Range {
+        float maxRange;
+        ConeSolver::RangeMetric metric;
+    };
+    const Range ranges[] = {
+        {0.0f, ConeSolver::EUCLIDEAN},
+        {20.5f, ConeSolver::EUCLIDEAN},
+        {23.0f, ConeSolver::MANHATTAN},
+    };
+    // One solver for every origin, so stale cells of earlier solves are
+    // left outside of the spans
+    IntervalSolver intervals;
+    for(int n : {64, 256})
+        for(Maps::Kind map : ALL_MAPS)
+            for(const Range& range : ranges) {
+                vec3i size = vec3i(n, n, 1);
+                for(const vec3i& origin : getOrigins(size)) {
+                    BlockerGrid blockers(size);
+                    Maps::generate(blockers, map, origin);
+                    ConeSolverDouble exact;
+                    ConeSolver rounded;
+                    exact.genMode2D = rounded.genMode2D = true;
+                    exact.maxRange = rounded.maxRange = intervals.maxRange = range.maxRange;
+                    rounded.rangeMetric = intervals.rangeMetric = range.metric;
+                    exact.rangeMetric = range.metric == ConeSolver::MANHATTAN ? ConeSolverDouble::MANHATTAN : ConeSolverDouble::EUCLIDEAN;
+                    BitSet visibleOut;
+                    intervals.visibleOut = &visibleOut;
+                    exact.solve(blockers, origin);
+                    rounded.solve(blockers, origin);
+                    intervals.solve(blockers, origin);
+                    BitSet a, b, c;
+                    intervals.getVisible(a);
+                    exact.getVisible(b);
+                    rounded.getVisible(c);
+                    std::size_t wrongIsVisible = 0;
+                    for(int y = 0; y < size.y; ++y)
+                        for(int x = 0; x < size.x; ++x)
+                            wrongIsVisible += intervals.isVisible(vec3i(x, y, 0)) != a.test(x + std::size_t(size.x)*y);
+                    std::ostringstream context;
+                    context << n << "x" << n << " " << Maps::getName(map) << " range " << range.maxRange <<
+                               (range.metric == ConeSolver::MANHATTAN ? " manhattan" : "") <<
+                               " origin " << origin.x << " " << origin.y;
+                    CHECK_CONTEXT(countDifferences(a, b) == 0, context.str() << " double");
+                    CHECK_CONTEXT(countDifferences(a, c) == 0, context.str() << " float");
+                    CHECK_CONTEXT(countDifferences(a, visibleOut) == 0, context.str() << " visibleOut");
+                    CHECK_CONTEXT(wrongIsVisible == 0, context.str() << " isVisible");
+                }
+            }
+}
@@ -0,0 +1,108 @@
+#include "Test.hpp"
+#include "Helpers.hpp"
+#include <core/OrthoSolver.hpp>
+#include <queue>
+
+static const vec3f DEFAULT_SUN_DIR = glm::normalize(vec3f(-1.0f, 1.4f, 0.0f));
+
+static bool isLit(const Square& s) {
+    return s.d.x > 0.0f || s.d.y > 0.0f;
+}
+
+// The original sweep the solver replaced: cells in increasing distance
+// along the sun direction out of a priority queue, each one pushing its light
+// to the neighbours that come after it. It only handles the default sun
+// direction, whose light enters through the x = size.x-1 and y = 0 borders.
+static std::vector<Square> solveBaseline(const BlockerGrid& blockers, const vec3f& sunDir) {
+    vec2i size = vec2i(blockers.getSize());
+    std::vector<Square> squares(std::size_t(size.x)*size.y, {{0.0f, 0.0f}, {0.0f, 0.0f}});
+    std::vector<unsigned char> queued(squares.size(), 0);
+    std::vector<unsigned char> visited(squares.size(), 0);
+    auto index = [&](const vec2i& p) { return p.x + std::size_t(size.x)*p.y; };
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> q;
+    auto push = [&](const vec2i& p) {
+        queued[index(p)] = 1;
+        q.push(std::make_pair(glm::dot(vec2f(p), vec2f(sunDir)), int(index(p))));
+    };
+    for(int y = 0; y < size.y; ++y) {
+        push(vec2i(size.x-1, y));
+        squares[index(vec2i(size.x-1, y))] = OrthoSolver::getFaceSquare(size.x-1, y, OrthoSolver::RIGHT, sunDir);
+    }
+    for(int x = 0; x < size.x; ++x) {
+        if(queued[index(vec2i(x, 0))] == 0) push(vec2i(x, 0));
+        squares[index(vec2i(x, 0))] = OrthoSolver::getFaceSquare(x, 0, OrthoSolver::RIGHT, sunDir);
+    }
+    vec2i diff[4] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+    while(!q.empty()) {
+        vec2i front = vec2i(q.top().second%size.x, q.top().second/size.x);
+        q.pop();
+        visited[index(front)] = 1;
+        for(int d = 0; d < 4; ++d) {
+            vec2i n = front + diff[d];
+            if(n.x < 0 || n.y < 0 || n.x >= size.x || n.y >= size.y) continue;
+            if(blockers.isBlocked(vec3i(n, 0)) || visited[index(n)]) continue;
+            if(queued[index(n)] == 0) push(n);
+            Square through = Square::squareIntersection(
+                OrthoSolver::getFaceSquare(front.x, front.y, OrthoSolver::Dir(d), sunDir),
+                squares[index(front)]);
+            squares[index(n)] = Square::squareUnion(squares[index(n)], through);
+        }
+    }
+    return squares;
+}
+
+// Face squares are translated copies now, so they may round differently in
+// the last bits, but what is lit must not change
+TEST(orthoSolveMatchesBaseline) {
+    for(Maps::Kind map : ALL_MAPS) {
+        vec3i size = vec3i(64, 64, 1);
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, map, vec3i(0));
+        OrthoSolver solver;
+        solver.solve(blockers, DEFAULT_SUN_DIR);
+        std::vector<Square> baseline = solveBaseline(blockers, DEFAULT_SUN_DIR);
+        std::size_t differentLit = 0;
+        float maxError = 0.0f;
+        for(int y = 0; y < size.y; ++y)
+            for(int x = 0; x < size.x; ++x) {
+                const Square& a = solver.getSquare(vec2i(x, y));
+                const Square& b = baseline[x + std::size_t(size.x)*y];
+                differentLit += isLit(a) != isLit(b);
+                vec2f error = glm::max(glm::abs(a.p - b.p), glm::abs(a.d - b.d));
+                maxError = glm::max(maxError, glm::max(error.x, error.y));
+            }
+        CHECK_CONTEXT(differentLit == 0, Maps::getName(map));
+        CHECK_CONTEXT(maxError < 0.0001f, Maps::getName(map) << " off by " << maxError);
+    }
+}
+
+// The sweep and the borders the light enters through follow the signs of
+// the sun direction, so mirroring both the map and the direction must
+// mirror what is lit
+TEST(orthoSolveMirrorsWithSunDir) {
+    for(Maps::Kind map : ALL_MAPS) {
+        vec3i size = vec3i(64, 48, 1);
+        BlockerGrid blockers(size);
+        Maps::generate(blockers, map, vec3i(0));
+        OrthoSolver reference;
+        reference.solve(blockers, DEFAULT_SUN_DIR);
+        for(int flip = 1; flip < 4; ++flip) {
+            vec2i sign = vec2i(flip & 1 ? -1 : 1, flip & 2 ? -1 : 1);
+            auto mirror = [&](int x, int y) {
+                return vec2i(sign.x > 0 ? x : size.x-1-x, sign.y > 0 ? y : size.y-1-y);
+            };
+            BlockerGrid mirrored(size);
+            for(int y = 0; y < size.y; ++y)
+                for(int x = 0; x < size.x; ++x)
+                    mirrored.setBlocked(vec3i(mirror(x, y), 0), blockers.isBlocked(vec3i(x, y, 0)));
+            OrthoSolver solver;
+            solver.solve(mirrored, DEFAULT_SUN_DIR*vec3f(sign.x, sign.y, 1.0f));
+            std::size_t differentLit = 0;
+            for(int y = 0; y < size.y; ++y)
+                for(int x = 0; x < size.x; ++x)
+                    differentLit += reference.isLit(vec2i(x, y)) != solver.isLit(mirror(x, y));
+            CHECK_CONTEXT(differentLit == 0, Maps::getName(map) << " mirrored " << sign.x << " " << sign.y);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#include "Test.hpp"
+#include <cstdio>
+
+struct Entry {
+    std::string name;
+    Test::Function function;
+};
+
+static std::vector<Entry>& getRegistry() {
+    static std::vector<Entry> registry;
+    return registry;
+}
+
+// Failures of the test that is running
+static int failures = 0;
+
+void Test::add(const std::string& name, Function f) {
+    getRegistry().push_back({name, f});
+}
+
+void Test::fail(const char* file, int line, const std::string& what) {
+    // Loops over many cells would otherwise flood the output
+    if(failures < 10) std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, what.c_str());
+    else if(failures == 10) std::fprintf(stderr, "...\n");
+    ++failures;
+}
+
+int Test::runAll(const std::string& filter) {
+    int failed = 0;
+    int run = 0;
+    for(const Entry& e : getRegistry()) {
+        if(e.name.find(filter) == std::string::npos) continue;
+        failures = 0;
+        e.function();
+        std::printf("%-60s %s\n", e.name.c_str(), failures == 0 ? "ok" : "FAILED");
+        std::fflush(stdout);
+        failed += failures != 0;
+        ++run;
+    }
+    std::printf("%d of %d tests failed\n", failed, run);
+    return failed;
+}
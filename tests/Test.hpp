@@ -0,0 +1,45 @@
+#ifndef TEST_HPP
+#define TEST_HPP
+
+#include <core/CoreCommons.hpp>
+#include <sstream>
+#include <string>
+
+// Tiny test runner, in the same spirit as the benchmark harness. A test is a
+// function registered with TEST that makes CHECKs. core is built without
+// exceptions, so a failed CHECK is reported and the test carries on.
+class Test {
+    public:
+        typedef void (*Function)();
+
+        struct Registrar {
+            Registrar(const char* name, Function f) { add(name, f); }
+        };
+
+        static void add(const std::string& name, Function f);
+        // Runs every test whose name contains filter. Returns how many of
+        // them failed.
+        static int runAll(const std::string& filter);
+
+        static void fail(const char* file, int line, const std::string& what);
+};
+
+#define TEST_CONCAT2(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT2(a, b)
+#define TEST(name) \
+    static void name(); \
+    static Test::Registrar TEST_CONCAT(testRegistrar, __LINE__)(#name, name); \
+    static void name()
+
+#define CHECK(expr) ((expr) ? (void)0 : Test::fail(__FILE__, __LINE__, #expr))
+// Same, with what is streamed into context added to the report, such as the
+// map and origin a loop is at
+#define CHECK_CONTEXT(expr, context) do { \
+        if(!(expr)) { \
+            std::ostringstream testContext; \
+            testContext << #expr << " (" << context << ")"; \
+            Test::fail(__FILE__, __LINE__, testContext.str()); \
+        } \
+    } while(0)
+
+#endif //TEST_HPP
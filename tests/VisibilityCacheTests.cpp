@@ -0,0 +1,50 @@
+#include "Test.hpp"
+#include "Helpers.hpp"
+#include <core/VisibilityCache.hpp>
+#include <algorithm>
+
+// Toggles random blockers, reporting each to the cache, and checks every
+// entry it still returns against solving from that origin again. Missing
+// entries are solved and inserted again, so the cache stays full.
+TEST(visibilityCacheKeepsOnlyValidEntries) {
+    std::mt19937 random(3);
+    std::size_t kept = 0;
+    for(int m = 0; m < CONE_MODE_COUNT; ++m)
+        for(Maps::Kind map : ALL_MAPS) {
+            ConeMode mode = ConeMode(m);
+            vec3i size = getModeSize(mode);
+            BlockerGrid blockers(size);
+            Maps::generate(blockers, map, size/2);
+            std::vector<vec3i> origins;
+            for(int i = 0; i < 12; ++i) {
+                vec3i origin = getRandomCell(random, size, vec3i(-1, -1, 0), mode == VOLUMETRIC);
+                if(!blockers.isBlocked(origin)) origins.push_back(origin);
+            }
+            ConeSolver solver;
+            setMode(solver, mode);
+            VisibilityCache cache(std::size_t(1) << 24);
+            cache.volumetric = mode == VOLUMETRIC;
+            BitSet visible;
+            for(int i = 0; i < 32; ++i) {
+                for(const vec3i& origin : origins) {
+                    const BitSet* cached = cache.find(blockers, origin);
+                    solver.solve(blockers, origin);
+                    solver.getVisible(visible);
+                    if(cached == nullptr) {
+                        cache.insert(blockers, origin, visible);
+                        continue;
+                    }
+                    ++kept;
+                    CHECK_CONTEXT(countDifferences(*cached, visible) == 0,
+                                  getModeName(mode) << " " << Maps::getName(map) << " toggle " << i);
+                }
+                vec3i changed;
+                do changed = getRandomCell(random, size, vec3i(-1, -1, 0), mode == VOLUMETRIC);
+                while(std::find(origins.begin(), origins.end(), changed) != origins.end());
+                blockers.toggle(changed);
+                cache.blockerChanged(blockers, changed);
+            }
+        }
+    // Otherwise the cache would pass by dropping everything
+    CHECK(kept > 0);
+}
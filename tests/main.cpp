@@ -0,0 +1,19 @@
+#include "Test.hpp"
+#include <cstdio>
+#include <cstring>
+
+static void usage() {
+    std::printf("Usage: tests [--filter=<substring>]\n");
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    for(int i = 1; i < argc; ++i) {
+        if(std::strncmp(argv[i], "--filter=", 9) == 0) filter = argv[i] + 9;
+        else {
+            usage();
+            return 1;
+        }
+    }
+    return Test::runAll(filter) == 0 ? 0 : 2;
+}
@@ -0,0 +1,36 @@
+CONFIG -= qt
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = tests
+
+TEMPLATE = app
+
+include(../core/core.pri)
+
+QMAKE_CXXFLAGS += -std=c++0x -fno-exceptions -pthread
+CONFIG(release, debug|release): DEFINES += NDEBUG
+
+# Only the header-only glm bundled with VBE is needed. The maps are the ones
+# the benchmarks run on, and the allocation counter is the bench harness's.
+INCLUDEPATH += . ../bench ../VBE/include
+
+SOURCES += \
+    main.cpp \
+    Test.cpp \
+    ../bench/Maps.cpp \
+    ../bench/Benchmark.cpp \
+    AllocationTests.cpp \
+    AngleBatchTests.cpp \
+    BlockerGridTests.cpp \
+    ChunkedBlockersTests.cpp \
+    ConeSolverTests.cpp \
+    IntervalSolverTests.cpp \
+    VisibilityCacheTests.cpp \
+    OrthoSolverTests.cpp
+
+HEADERS += \
+    Test.hpp \
+    Helpers.hpp \
+    ../bench/Maps.hpp \
+    ../bench/Benchmark.hpp